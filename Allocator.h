@@ -2,8 +2,14 @@
 
 #include <iostream>
 #include <algorithm>
-#include <list>
-#include "Stack.h"
+#include <map>
+#include <set>
+#include <array>
+#include <cstdint>
+#include <cstdlib>
+#include <stdexcept>
+#include <utility>
+#include "AllocatorStats.h"
 
 namespace Allocators {
 
@@ -12,13 +18,514 @@ namespace Allocators {
         Occupied
     };
 
-    struct MemoryNode {
-        char *beginning;
-        size_t capacity;
-        MemoryNodeType type;
+    // Every block of the arena is framed by a header and a footer tag, both holding the
+    // block size with the lowest bit set for occupied blocks. A pointer maps straight to
+    // its header, and the neighbours are found through the header of the next block and
+    // the footer of the previous one. Holes keep their free list links in the payload.
+    struct Block {
+        static constexpr size_t kAlignment = 16;
+        static constexpr size_t kTagSize = sizeof(size_t);
+        static constexpr size_t kOverhead = 2 * kTagSize;
+        static constexpr size_t kMinSize = 32;
+        static constexpr size_t kOccupiedBit = 1;
+
+        struct Links {
+            char *next;
+            char *prev;
+        };
+
+        static size_t &Header(char *block) {
+            return *reinterpret_cast<size_t *>(block);
+        }
+
+        static size_t &Footer(char *block) {
+            return *reinterpret_cast<size_t *>(block + Size(block) - kTagSize);
+        }
+
+        static size_t Size(char *block) {
+            return Header(block) & ~kOccupiedBit;
+        }
+
+        static MemoryNodeType Type(char *block) {
+            return (Header(block) & kOccupiedBit) ? MemoryNodeType::Occupied : MemoryNodeType::Hole;
+        }
+
+        static void Mark(char *block, size_t size, MemoryNodeType type) {
+            size_t tag = size | (type == MemoryNodeType::Occupied ? kOccupiedBit : 0);
+            Header(block) = tag;
+            Footer(block) = tag;
+        }
+
+        static char *Next(char *block) {
+            return block + Size(block);
+        }
+
+        static MemoryNodeType PrevType(char *block) {
+            size_t tag = *reinterpret_cast<size_t *>(block - kTagSize);
+            return (tag & kOccupiedBit) ? MemoryNodeType::Occupied : MemoryNodeType::Hole;
+        }
+
+        static char *Prev(char *block) {
+            size_t tag = *reinterpret_cast<size_t *>(block - kTagSize);
+            return block - (tag & ~kOccupiedBit);
+        }
+
+        static char *Payload(char *block) {
+            return block + kTagSize;
+        }
+
+        static char *FromPayload(void *ptr) {
+            return static_cast<char *>(ptr) - kTagSize;
+        }
+
+        static Links &LinksOf(char *block) {
+            return *reinterpret_cast<Links *>(Payload(block));
+        }
+
+        static size_t SizeFor(size_t bytes) {
+            size_t size = (bytes + kOverhead + kAlignment - 1) & ~(kAlignment - 1);
+            return std::max(size, kMinSize);
+        }
+    };
+
+    // Doubly linked list of holes threaded through their payloads.
+    struct FreeList {
+        void Push(char *block) {
+            Block::LinksOf(block) = {head, nullptr};
+            if (head != nullptr) {
+                Block::LinksOf(head).prev = block;
+            }
+            head = block;
+        }
+
+        void Remove(char *block) {
+            Block::Links &links = Block::LinksOf(block);
+            if (links.prev != nullptr) {
+                Block::LinksOf(links.prev).next = links.next;
+            } else {
+                head = links.next;
+            }
+            if (links.next != nullptr) {
+                Block::LinksOf(links.next).prev = links.prev;
+            }
+        }
+
+        bool Empty() const {
+            return head == nullptr;
+        }
+
+        char *head = nullptr;
+    };
+
+    // Single list of holes, takes the first one that is big enough.
+    class FirstFit {
+    public:
+        void AddHole(char *block) {
+            holes_.Push(block);
+        }
+
+        void RemoveHole(char *block) {
+            holes_.Remove(block);
+        }
+
+        char *Find(size_t size) {
+            for (char *block = holes_.head; block != nullptr; block = Block::LinksOf(block).next) {
+                if (Block::Size(block) >= size) {
+                    return block;
+                }
+            }
+            return nullptr;
+        }
+
+    private:
+        FreeList holes_;
     };
 
-    template<typename T, size_t ALLOC_SIZE>
+    // Keeps holes in two-level size classes: each power-of-two range is split into
+    // kSubCount equal subclasses, and bitmaps mark the non-empty ones. A request is
+    // rounded up to the next subclass boundary, so every hole of the lowest non-empty
+    // subclass from there on fits and its head is taken in O(1), wasting at most a
+    // 1/kSubCount part of the hole. Only when there is none is the subclass of the
+    // request itself searched for a fit.
+    class SegregatedFit {
+    public:
+        void AddHole(char *block) {
+            Class bin = ClassOf(Block::Size(block));
+            bins_[bin.first][bin.second].Push(block);
+            used_sub_bins_[bin.first] |= (uint32_t(1) << bin.second);
+            used_bins_ |= (uint64_t(1) << bin.first);
+        }
+
+        void RemoveHole(char *block) {
+            Class bin = ClassOf(Block::Size(block));
+            bins_[bin.first][bin.second].Remove(block);
+            if (bins_[bin.first][bin.second].Empty()) {
+                used_sub_bins_[bin.first] &= ~(uint32_t(1) << bin.second);
+                if (used_sub_bins_[bin.first] == 0) {
+                    used_bins_ &= ~(uint64_t(1) << bin.first);
+                }
+            }
+        }
+
+        char *Find(size_t size) {
+            Class bin = ClassOf(size + (size_t(1) << (BinIndex(size) - kSubBits)) - 1);
+            uint32_t sub_bins = used_sub_bins_[bin.first] & (~uint32_t(0) << bin.second);
+            if (sub_bins != 0) {
+                return bins_[bin.first][LowestBit(sub_bins)].head;
+            }
+            uint64_t bigger = (bin.first + 1 < kBinsCount) ? used_bins_ & (~uint64_t(0) << (bin.first + 1)) : 0;
+            if (bigger != 0) {
+                size_t first = LowestBit(bigger);
+                return bins_[first][LowestBit(used_sub_bins_[first])].head;
+            }
+            Class own = ClassOf(size);
+            for (char *block = bins_[own.first][own.second].head; block != nullptr; block = Block::LinksOf(block).next) {
+                if (Block::Size(block) >= size) {
+                    return block;
+                }
+            }
+            return nullptr;
+        }
+
+    private:
+        static constexpr size_t kBinsCount = 64;
+        static constexpr size_t kSubBits = 4;
+        static constexpr size_t kSubCount = size_t(1) << kSubBits;
+
+        static_assert(Block::kMinSize >= kSubCount, "Blocks must be at least one subclass step wide");
+
+        // Power-of-two range and subclass within it.
+        using Class = std::pair<size_t, size_t>;
+
+        static Class ClassOf(size_t size) {
+            size_t bin = BinIndex(size);
+            return {bin, (size >> (bin - kSubBits)) & (kSubCount - 1)};
+        }
+
+        static size_t BinIndex(size_t size) {
+            size_t bin = 0;
+            while (size >>= 1) {
+                ++bin;
+            }
+            return bin;
+        }
+
+        static size_t LowestBit(uint64_t mask) {
+            size_t bit = 0;
+            while (!(mask & 1)) {
+                mask >>= 1;
+                ++bit;
+            }
+            return bit;
+        }
+
+        std::array<std::array<FreeList, kSubCount>, kBinsCount> bins_;
+        std::array<uint32_t, kBinsCount> used_sub_bins_{};
+        uint64_t used_bins_ = 0;
+    };
+
+    // Growth policies tell a growing arena how big its next chunk should be, given the
+    // capacity it was created with, the capacity of the biggest chunk it holds and the
+    // block that did not fit. A result smaller than the block means the arena is
+    // exhausted.
+    struct NoGrowth {
+        static size_t NextChunkSize(size_t, size_t, size_t) {
+            return 0;
+        }
+    };
+
+    // Every chunk is one initial capacity bigger than the biggest one, rounded up to
+    // a whole number of initial capacities that holds the block, so n chunks hold
+    // about n^2 / 2 initial capacities.
+    struct LinearGrowth {
+        static size_t NextChunkSize(size_t initial, size_t last, size_t required) {
+            if (initial == 0) {
+                return std::max(last, required);
+            }
+            size_t steps = std::max(last / initial + 1, (required + initial - 1) / initial);
+            return steps * initial;
+        }
+    };
+
+    struct GeometricGrowth {
+        static size_t NextChunkSize(size_t, size_t last, size_t required) {
+            return std::max(2 * last, required);
+        }
+    };
+
+    // Untyped boundary-tag heap over a chain of malloc'ed chunks. When no hole fits,
+    // a new chunk is added as the growth policy says. A chunk that becomes one whole
+    // hole again is kept as a spare for the next allocations; when there already is
+    // one, the smaller of the two is given back to the system. The first chunk of an
+    // otherwise empty chain is always kept. Chunks are kept by address, so finding the
+    // chunk of a pointer costs O(log chunks).
+    template<typename FitPolicy = FirstFit, typename GrowthPolicy = GeometricGrowth>
+    class Arena {
+    public:
+        explicit Arena(size_t size) : initial_size_(size) {
+            AddChunk(size);
+        }
+
+        ~Arena() {
+            for (auto &item : chunks_) {
+                free(item.second);
+            }
+        }
+
+        Arena(const Arena &) = delete;
+
+        Arena(Arena &&) = delete;
+
+        // Payloads are always aligned to Block::kAlignment. A bigger power-of-two
+        // alignment is served from a hole large enough to skip to an aligned payload;
+        // the skipped front part stays a hole of its own.
+        void *Allocate(size_t bytes, size_t alignment = Block::kAlignment) {
+            LatencyTimer timer(counters_.AllocateLatency());
+            if (alignment == 0 || (alignment & (alignment - 1)) != 0) {
+                throw std::runtime_error("Wrong alignment");
+            }
+            if (bytes > SIZE_MAX / 4 || alignment > SIZE_MAX / 4) {
+                throw std::runtime_error("No memory");
+            }
+            size_t size = Block::SizeFor(bytes);
+            if (alignment <= Block::kAlignment) {
+                char *block = TakeHole(size);
+                void *ptr = Carve(block, size);
+                counters_.OnAllocate(Block::Size(block));
+                return ptr;
+            }
+            char *block = TakeHole(size + alignment + Block::kMinSize);
+            size_t lead = LeadFor(block, alignment);
+            if (lead != 0) {
+                size_t capacity = Block::Size(block);
+                Block::Mark(block, lead, MemoryNodeType::Hole);
+                policy_.AddHole(block);
+                block += lead;
+                Block::Mark(block, capacity - lead, MemoryNodeType::Hole);
+            }
+            void *ptr = Carve(block, size);
+            counters_.OnAllocate(Block::Size(block));
+            return ptr;
+        }
+
+        void Deallocate(void *ptr) {
+            LatencyTimer timer(counters_.DeallocateLatency());
+            char *block = Block::FromPayload(ptr);
+            if (!Owns(block) || Block::Type(block) != MemoryNodeType::Occupied) {
+                throw std::runtime_error("Wrong ptr to deallocate");
+            }
+            size_t size = Block::Size(block);
+            counters_.OnDeallocate(size);
+            if (Block::PrevType(block) == MemoryNodeType::Hole) {
+                char *prev = Block::Prev(block);
+                policy_.RemoveHole(prev);
+                size += Block::Size(prev);
+                block = prev;
+            }
+            char *next = block + size;
+            if (Block::Type(next) == MemoryNodeType::Hole) {
+                policy_.RemoveHole(next);
+                size += Block::Size(next);
+            }
+            Block::Mark(block, size, MemoryNodeType::Hole);
+            policy_.AddHole(block);
+            if (chunks_.size() > 1 && IsWholeChunk(block)) {
+                KeepSpare(OwnerOf(block));
+            }
+        }
+
+        // Grows or shrinks an occupied block without moving it: growing takes the front
+        // of the hole right behind the block, shrinking gives the tail back as a hole.
+        // Returns false when the neighbour cannot provide the extra space.
+        bool TryResize(void *ptr, size_t bytes) {
+            char *block = Block::FromPayload(ptr);
+            if (!Owns(block) || Block::Type(block) != MemoryNodeType::Occupied) {
+                throw std::runtime_error("Wrong ptr to resize");
+            }
+            if (bytes > SIZE_MAX / 4) {
+                return false;
+            }
+            size_t size = Block::SizeFor(bytes);
+            size_t capacity = Block::Size(block);
+            char *next = Block::Next(block);
+            if (Block::Type(next) == MemoryNodeType::Hole) {
+                policy_.RemoveHole(next);
+                capacity += Block::Size(next);
+            } else if (capacity < size) {
+                return false;
+            }
+            if (capacity < size) {
+                policy_.AddHole(next);
+                return false;
+            }
+            size_t old_size = Block::Size(block);
+            Block::Mark(block, capacity, MemoryNodeType::Occupied);
+            Carve(block, size);
+            counters_.OnResize(old_size, Block::Size(block));
+            return true;
+        }
+
+        // Walks every block, so it costs time proportional to the number of blocks.
+        ArenaStats GetStats() const {
+            ArenaStats stats;
+            counters_.Fill(stats);
+            for (auto &item : chunks_) {
+                Chunk *chunk = item.second;
+                stats.reserved_bytes += chunk->last - chunk->first;
+                for (char *block = chunk->first; block != chunk->last; block = Block::Next(block)) {
+                    size_t size = Block::Size(block);
+                    if (Block::Type(block) == MemoryNodeType::Occupied) {
+                        stats.bytes_in_use += size;
+                    } else {
+                        ++stats.holes_count;
+                        stats.free_bytes += size;
+                        stats.largest_hole = std::max(stats.largest_hole, size);
+                    }
+                }
+            }
+            stats.peak_bytes_in_use = std::max(stats.peak_bytes_in_use, stats.bytes_in_use);
+            return stats;
+        }
+
+    private:
+        struct Chunk {
+            char *first;
+            char *last;
+        };
+
+        // Chunk layout: the Chunk record, alignment padding, a back pointer to the record,
+        // a spare tag, an occupied footer, the blocks, an occupied empty header.
+        static constexpr size_t kPrefixSize = 3 * Block::kTagSize;
+        static constexpr size_t kChunkOverhead = sizeof(Chunk) + Block::kAlignment + kPrefixSize + Block::kTagSize;
+
+        char *AddChunk(size_t capacity) {
+            char *raw = (char *) malloc(capacity + kChunkOverhead);
+            if (raw == nullptr) {
+                throw std::runtime_error("No memory");
+            }
+            Chunk *chunk = reinterpret_cast<Chunk *>(raw);
+            char *start = raw + sizeof(Chunk);
+            start += (Block::kAlignment - reinterpret_cast<uintptr_t>(start) % Block::kAlignment) % Block::kAlignment;
+            *reinterpret_cast<Chunk **>(start) = chunk;
+            chunk->first = start + kPrefixSize;
+            *reinterpret_cast<size_t *>(chunk->first - Block::kTagSize) = Block::kOccupiedBit;
+            size_t usable = capacity & ~(Block::kAlignment - 1);
+            char *hole = nullptr;
+            if (usable >= Block::kMinSize) {
+                hole = chunk->first;
+                Block::Mark(hole, usable, MemoryNodeType::Hole);
+                policy_.AddHole(hole);
+                chunk->last = chunk->first + usable;
+            } else {
+                chunk->last = chunk->first;
+            }
+            Block::Header(chunk->last) = Block::kOccupiedBit;
+            chunks_.emplace(chunk->last, chunk);
+            capacities_.insert(chunk->last - chunk->first);
+            return hole;
+        }
+
+        char *TakeHole(size_t size) {
+            char *block = policy_.Find(size);
+            if (block == nullptr) {
+                block = Grow(size);
+            }
+            policy_.RemoveHole(block);
+            return block;
+        }
+
+        // Marks the front of a taken hole occupied and puts the rest back as a hole.
+        void *Carve(char *block, size_t size) {
+            size_t capacity = Block::Size(block);
+            if (capacity - size >= Block::kMinSize) {
+                Block::Mark(block, size, MemoryNodeType::Occupied);
+                char *rest = Block::Next(block);
+                Block::Mark(rest, capacity - size, MemoryNodeType::Hole);
+                policy_.AddHole(rest);
+            } else {
+                Block::Mark(block, capacity, MemoryNodeType::Occupied);
+            }
+            return Block::Payload(block);
+        }
+
+        // Distance from the block to the first block start whose payload is aligned,
+        // leaving either nothing or a whole hole in front.
+        static size_t LeadFor(char *block, size_t alignment) {
+            uintptr_t payload = reinterpret_cast<uintptr_t>(Block::Payload(block));
+            size_t lead = (alignment - payload % alignment) % alignment;
+            if (lead != 0 && lead < Block::kMinSize) {
+                lead += alignment;
+            }
+            return lead;
+        }
+
+        // The next chunk is sized from the chunks held now, so giving chunks back
+        // also lets the chunk size come down again.
+        char *Grow(size_t size) {
+            size_t capacity = GrowthPolicy::NextChunkSize(initial_size_, BiggestChunk(), size);
+            if (capacity < size) {
+                throw std::runtime_error("No memory");
+            }
+            return AddChunk(capacity);
+        }
+
+        size_t BiggestChunk() const {
+            return capacities_.empty() ? 0 : *capacities_.rbegin();
+        }
+
+        // The only chunk that may hold the block is the first one ending after it.
+        bool Owns(char *block) const {
+            auto it = chunks_.upper_bound(block);
+            return it != chunks_.end() && block >= it->second->first;
+        }
+
+        static bool IsWholeChunk(char *block) {
+            return *reinterpret_cast<size_t *>(block - Block::kTagSize) == Block::kOccupiedBit &&
+                   Block::Header(Block::Next(block)) == Block::kOccupiedBit;
+        }
+
+        static Chunk *OwnerOf(char *first_block) {
+            return *reinterpret_cast<Chunk **>(first_block - kPrefixSize);
+        }
+
+        // Whether the chunk is still one whole hole; the spare may have been
+        // allocated from since it was put aside.
+        static bool IsEmpty(Chunk *chunk) {
+            return chunk->first != chunk->last && Block::Type(chunk->first) == MemoryNodeType::Hole &&
+                   IsWholeChunk(chunk->first);
+        }
+
+        // Called with a chunk that just became one whole hole.
+        void KeepSpare(Chunk *chunk) {
+            if (spare_ == nullptr || spare_ == chunk || !IsEmpty(spare_)) {
+                spare_ = chunk;
+                return;
+            }
+            Chunk *released = chunk;
+            if (spare_->last - spare_->first < chunk->last - chunk->first) {
+                released = spare_;
+                spare_ = chunk;
+            }
+            policy_.RemoveHole(released->first);
+            ReleaseChunk(released);
+        }
+
+        void ReleaseChunk(Chunk *chunk) {
+            chunks_.erase(chunk->last);
+            capacities_.erase(capacities_.find(chunk->last - chunk->first));
+            free(chunk);
+        }
+
+        // Chunks by the end of their blocks, and the multiset of their capacities.
+        std::map<char *, Chunk *, std::less<>> chunks_;
+        std::multiset<size_t> capacities_;
+        Chunk *spare_ = nullptr;
+        size_t initial_size_;
+        FitPolicy policy_;
+        StatsCounters counters_;
+    };
+
+    template<typename T, size_t ALLOC_SIZE, typename FitPolicy = FirstFit, typename GrowthPolicy = GeometricGrowth>
     class Allocator {
     public:
         using value_type = T;
@@ -32,69 +539,41 @@ namespace Allocators {
 
         template<class V>
         struct rebind {
-            using other = Allocator<V, ALLOC_SIZE>;
+            using other = Allocator<V, ALLOC_SIZE, FitPolicy, GrowthPolicy>;
         };
 
-        Allocator() {
-            data = (char *) malloc(ALLOC_SIZE);
-            mem_list.Insert(mem_list.begin(), {data, ALLOC_SIZE, MemoryNodeType::Hole});
+        Allocator() : arena_(ALLOC_SIZE) {}
+
+        T *allocate(size_t mem_size) {
+            return static_cast<T *>(arena_.Allocate(mem_size * sizeof(T), alignof(T)));
         }
 
-        ~Allocator() {
-            free(data);
+        // For SIMD data or cache-line isolated objects. Freed with deallocate_aligned,
+        // which every allocator here has; for this one it is the same as deallocate.
+        T *allocate_aligned(size_t mem_size, size_t alignment) {
+            return static_cast<T *>(arena_.Allocate(mem_size * sizeof(T), std::max(alignment, alignof(T))));
         }
 
-        T *allocate(size_t mem_size) {
-            mem_size *= sizeof(T);
-            auto it = std::find_if(mem_list.begin(), mem_list.end(), [&mem_size](const MemoryNode &node) {
-                return node.type == MemoryNodeType::Hole && node.capacity >= mem_size;
-            });
-            if (it == mem_list.end()) {
-                throw std::runtime_error("No memory");
-            }
-            if (it->capacity == mem_size) {
-                it->type = MemoryNodeType::Occupied;
-            } else {
-                auto next = std::next(it);
-                mem_list.Insert(std::next(it),
-                                MemoryNode{it->beginning + mem_size, it->capacity - mem_size, MemoryNodeType::Hole});
-                it->type = MemoryNodeType::Occupied;
-                it->capacity = mem_size;
-            }
-            return (T *) it->beginning;
+        void deallocate(T *typed_ptr, size_t) {
+            arena_.Deallocate(typed_ptr);
         }
 
+        void deallocate_aligned(T *typed_ptr, size_t, size_t) {
+            arena_.Deallocate(typed_ptr);
+        }
 
-        void deallocate(T *typed_ptr, size_t) {
-            auto cur_it = std::find_if(mem_list.begin(), mem_list.end(), [&typed_ptr](const MemoryNode &node) {
-                return node.type == MemoryNodeType::Occupied && node.beginning == (char *) typed_ptr;
-            });
-            auto prev_it = mem_list.end();
-            for (auto it = mem_list.begin(); it != mem_list.end(); ++it) {
-                if (std::next(it) == cur_it) {
-                    prev_it = it;
-                    break;
-                }
-            }
-            if (cur_it == mem_list.end()) {
-                throw std::runtime_error("Wrong ptr to deallocate");
-            }
-            cur_it->type = MemoryNodeType::Hole;
-            if (cur_it != mem_list.begin() && prev_it->type == MemoryNodeType::Hole) {
-                cur_it = prev_it;
-                cur_it->capacity += std::next(cur_it)->capacity;
-                mem_list.Erase(std::next(cur_it));
-            }
-            if (std::next(cur_it) != mem_list.end() && std::next(cur_it)->type == MemoryNodeType::Hole) {
-                cur_it->capacity += std::next(cur_it)->capacity;
-                mem_list.Erase(std::next(cur_it));
-            }
+        // Resizes the block of ptr in place to hold mem_size objects, see Arena::TryResize.
+        bool try_expand(T *typed_ptr, size_t mem_size) {
+            return arena_.TryResize(typed_ptr, mem_size * sizeof(T));
+        }
+
+        ArenaStats GetStats() const {
+            return arena_.GetStats();
         }
 
     private:
 
-        Containers::Stack<MemoryNode> mem_list;
-        char *data;
+        Arena<FitPolicy, GrowthPolicy> arena_;
     };
 
 }
\ No newline at end of file
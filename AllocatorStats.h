@@ -0,0 +1,229 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+
+// Build with ALLOCATORS_ENABLE_STATS to count calls and track the peak usage, and
+// with ALLOCATORS_ENABLE_LATENCY to also time every call. Without them the hooks
+// below are empty and compile away; the snapshot still reports what can be read
+// from the arena itself.
+#if defined(ALLOCATORS_ENABLE_LATENCY) && !defined(ALLOCATORS_ENABLE_STATS)
+#define ALLOCATORS_ENABLE_STATS
+#endif
+
+namespace Allocators {
+
+    // Power-of-two buckets of call latency in nanoseconds: bucket i counts calls
+    // that took [2^i, 2^(i+1)) ns, the first bucket also takes zero.
+    struct LatencyHistogram {
+        static constexpr size_t kBucketsCount = 32;
+
+        void Record(uint64_t nanoseconds) {
+            size_t bucket = 0;
+            while (nanoseconds >>= 1) {
+                ++bucket;
+            }
+            ++buckets[std::min(bucket, kBucketsCount - 1)];
+        }
+
+        uint64_t Count() const {
+            uint64_t count = 0;
+            for (uint64_t bucket : buckets) {
+                count += bucket;
+            }
+            return count;
+        }
+
+        std::array<uint64_t, kBucketsCount> buckets{};
+    };
+
+    struct ArenaStats {
+        size_t reserved_bytes = 0;
+        size_t bytes_in_use = 0;
+        size_t peak_bytes_in_use = 0;
+        size_t holes_count = 0;
+        size_t free_bytes = 0;
+        size_t largest_hole = 0;
+        size_t allocations = 0;
+        size_t deallocations = 0;
+        LatencyHistogram allocate_latency;
+        LatencyHistogram deallocate_latency;
+
+        // Share of free memory that is not in the largest hole: 0 when all free space
+        // is one hole, close to 1 when it is scattered in small pieces.
+        double Fragmentation() const {
+            if (free_bytes == 0) {
+                return 0;
+            }
+            return 1 - double(largest_hole) / double(free_bytes);
+        }
+
+        void Print(std::ostream &os) const {
+            os << "reserved bytes : " << reserved_bytes << '\n';
+            os << "bytes in use : " << bytes_in_use << '\n';
+            os << "peak bytes in use : " << peak_bytes_in_use << '\n';
+            os << "holes : " << holes_count << '\n';
+            os << "free bytes : " << free_bytes << '\n';
+            os << "largest hole : " << largest_hole << '\n';
+            os << "fragmentation : " << Fragmentation() << '\n';
+            os << "allocations : " << allocations << '\n';
+            os << "deallocations : " << deallocations << '\n';
+            PrintHistogram(os, "allocate latency", allocate_latency);
+            PrintHistogram(os, "deallocate latency", deallocate_latency);
+        }
+
+        void PrintJson(std::ostream &os) const {
+            os << "{\"reserved_bytes\": " << reserved_bytes
+               << ", \"bytes_in_use\": " << bytes_in_use
+               << ", \"peak_bytes_in_use\": " << peak_bytes_in_use
+               << ", \"holes_count\": " << holes_count
+               << ", \"free_bytes\": " << free_bytes
+               << ", \"largest_hole\": " << largest_hole
+               << ", \"fragmentation\": " << Fragmentation()
+               << ", \"allocations\": " << allocations
+               << ", \"deallocations\": " << deallocations
+               << ", \"allocate_latency_ns\": ";
+            PrintHistogramJson(os, allocate_latency);
+            os << ", \"deallocate_latency_ns\": ";
+            PrintHistogramJson(os, deallocate_latency);
+            os << "}\n";
+        }
+
+    private:
+        static void PrintHistogram(std::ostream &os, const char *name, const LatencyHistogram &histogram) {
+            if (histogram.Count() == 0) {
+                return;
+            }
+            os << name << " :\n";
+            for (size_t i = 0; i < LatencyHistogram::kBucketsCount; ++i) {
+                if (histogram.buckets[i] != 0) {
+                    os << "  < " << (uint64_t(1) << (i + 1)) << " ns : " << histogram.buckets[i] << '\n';
+                }
+            }
+        }
+
+        static void PrintHistogramJson(std::ostream &os, const LatencyHistogram &histogram) {
+            os << '[';
+            for (size_t i = 0; i < LatencyHistogram::kBucketsCount; ++i) {
+                os << (i == 0 ? "" : ", ") << histogram.buckets[i];
+            }
+            os << ']';
+        }
+    };
+
+    // Records the time from construction to destruction into a histogram.
+    class LatencyTimer {
+    public:
+#ifdef ALLOCATORS_ENABLE_LATENCY
+        explicit LatencyTimer(LatencyHistogram *histogram)
+                : histogram_(histogram), start_(std::chrono::steady_clock::now()) {}
+
+        ~LatencyTimer() {
+            auto elapsed = std::chrono::steady_clock::now() - start_;
+            histogram_->Record(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+        }
+
+    private:
+        LatencyHistogram *histogram_;
+        std::chrono::steady_clock::time_point start_;
+#else
+        explicit LatencyTimer(LatencyHistogram *) {}
+#endif
+    };
+
+    // Running counters an arena updates on every call.
+    class StatsCounters {
+    public:
+#ifdef ALLOCATORS_ENABLE_STATS
+        void OnAllocate(size_t block_size) {
+            ++allocations_;
+            in_use_ += block_size;
+            peak_ = std::max(peak_, in_use_);
+        }
+
+        void OnDeallocate(size_t block_size) {
+            ++deallocations_;
+            in_use_ -= block_size;
+        }
+
+        void OnResize(size_t old_size, size_t new_size) {
+            in_use_ = in_use_ - old_size + new_size;
+            peak_ = std::max(peak_, in_use_);
+        }
+
+        LatencyHistogram *AllocateLatency() {
+            return &allocate_latency_;
+        }
+
+        LatencyHistogram *DeallocateLatency() {
+            return &deallocate_latency_;
+        }
+
+        void Fill(ArenaStats &stats) const {
+            stats.peak_bytes_in_use = peak_;
+            stats.allocations = allocations_;
+            stats.deallocations = deallocations_;
+            stats.allocate_latency = allocate_latency_;
+            stats.deallocate_latency = deallocate_latency_;
+        }
+
+    private:
+        size_t in_use_ = 0;
+        size_t peak_ = 0;
+        size_t allocations_ = 0;
+        size_t deallocations_ = 0;
+        LatencyHistogram allocate_latency_;
+        LatencyHistogram deallocate_latency_;
+#else
+        void OnAllocate(size_t) {}
+
+        void OnDeallocate(size_t) {}
+
+        void OnResize(size_t, size_t) {}
+
+        LatencyHistogram *AllocateLatency() {
+            return nullptr;
+        }
+
+        LatencyHistogram *DeallocateLatency() {
+            return nullptr;
+        }
+
+        void Fill(ArenaStats &) const {}
+#endif
+    };
+
+    // Counts the calls of an allocator front end that does not forward every call to
+    // its arena; added into a snapshot in place of the arena's own counts.
+    class CallCounters {
+    public:
+#ifdef ALLOCATORS_ENABLE_STATS
+        void OnAllocate() {
+            ++allocations_;
+        }
+
+        void OnDeallocate() {
+            ++deallocations_;
+        }
+
+        void AddTo(ArenaStats &stats) const {
+            stats.allocations += allocations_;
+            stats.deallocations += deallocations_;
+        }
+
+    private:
+        size_t allocations_ = 0;
+        size_t deallocations_ = 0;
+#else
+        void OnAllocate() {}
+
+        void OnDeallocate() {}
+
+        void AddTo(ArenaStats &) const {}
+#endif
+    };
+
+}
@@ -0,0 +1,263 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "rectangle.h"
+
+namespace Containers {
+
+    // Order-statistics index over the areas of rectangles identified by their index
+    // in a container: a treap ordered by (area, id) whose nodes carry subtree sizes.
+    // Nodes live in one array indexed by id, so updates allocate nothing once the
+    // ids have been seen. For integer T the key is the exact integer area, the cross
+    // product of two sides, so counts agree with rectangle::area_less_than exactly
+    // and every count is one O(log n) descent; other T use the cached area.
+    template<typename T>
+    class AreaIndex {
+    public:
+        using Key = std::conditional_t<std::is_integral<T>::value, uint64_t, double>;
+
+        // Indexes the rectangles of [first, last) under their positions: one sort,
+        // then the treap is assembled in a single pass over the sorted ids.
+        template<typename ForwardIt>
+        void Build(ForwardIt first, ForwardIt last) {
+            nodes_.clear();
+            root_ = kNone;
+            std::vector<size_t> order;
+            for (size_t id = 0; first != last; ++first, ++id) {
+                nodes_.emplace_back();
+                if (first->existance) {
+                    Reset(id, *first);
+                    order.push_back(id);
+                }
+            }
+            std::sort(order.begin(), order.end(), [this](size_t lhs, size_t rhs) {
+                return Less(lhs, nodes_[rhs].key, rhs);
+            });
+            std::vector<size_t> right_spine;
+            for (size_t id : order) {
+                size_t last_popped = kNone;
+                while (!right_spine.empty() && nodes_[right_spine.back()].priority < nodes_[id].priority) {
+                    last_popped = right_spine.back();
+                    right_spine.pop_back();
+                    Pull(last_popped);
+                }
+                nodes_[id].left = last_popped;
+                if (!right_spine.empty()) {
+                    nodes_[right_spine.back()].right = id;
+                }
+                right_spine.push_back(id);
+            }
+            while (!right_spine.empty()) {
+                Pull(right_spine.back());
+                right_spine.pop_back();
+            }
+            root_ = order.empty() ? kNone : FindRoot(order);
+        }
+
+        // Puts rect under id, replacing what was there. Rectangles that do not exist
+        // (default-constructed ones) are only removed.
+        void Update(size_t id, const rectangle<T> &rect) {
+            Erase(id);
+            if (!rect.existance) {
+                return;
+            }
+            if (id >= nodes_.size()) {
+                nodes_.resize(id + 1);
+            }
+            Reset(id, rect);
+            Children parts = Split(root_, nodes_[id].key, id);
+            root_ = Merge(Merge(parts.first, id), parts.second);
+        }
+
+        void Erase(size_t id) {
+            if (id >= nodes_.size() || !nodes_[id].indexed) {
+                return;
+            }
+            root_ = Erase(root_, nodes_[id].key, id);
+            nodes_[id].indexed = false;
+        }
+
+        // Forgets ids from size on, after the indexed container shrank.
+        void Truncate(size_t size) {
+            for (size_t id = size; id < nodes_.size(); ++id) {
+                Erase(id);
+            }
+            nodes_.resize(std::min(size, nodes_.size()));
+        }
+
+        size_t Size() const {
+            return SizeOf(root_);
+        }
+
+        // Rectangles with area less than square. An integer area is less than square
+        // exactly when it is less than square rounded up.
+        size_t CountBelow(double square) const {
+            if constexpr (std::is_integral<T>::value) {
+                if (!(square > 0)) {
+                    return 0;
+                }
+                if (square >= 18446744073709551616.0) {
+                    return Size();
+                }
+                return CountLess(Key(std::ceil(square)));
+            } else {
+                return CountLess(square);
+            }
+        }
+
+        // Rectangles with low <= area < high.
+        size_t CountInRange(double low, double high) const {
+            size_t below_high = CountBelow(high);
+            size_t below_low = CountBelow(low);
+            return below_high > below_low ? below_high - below_low : 0;
+        }
+
+        // Id of the rectangle with the k-th smallest area, counting from 0; equal
+        // areas are ordered by id.
+        size_t KthSmallest(size_t k) const {
+            if (k >= Size()) {
+                throw std::out_of_range("Out of bounds");
+            }
+            size_t node = root_;
+            while (true) {
+                size_t left_size = SizeOf(nodes_[node].left);
+                if (k < left_size) {
+                    node = nodes_[node].left;
+                } else if (k == left_size) {
+                    return node;
+                } else {
+                    k -= left_size + 1;
+                    node = nodes_[node].right;
+                }
+            }
+        }
+
+    private:
+        static constexpr size_t kNone = SIZE_MAX;
+
+        struct Node {
+            Key key = 0;
+            uint32_t priority = 0;
+            size_t left = kNone;
+            size_t right = kNone;
+            size_t size = 0;
+            bool indexed = false;
+        };
+
+        using Children = std::pair<size_t, size_t>;
+
+        static Key KeyOf(const rectangle<T> &rect) {
+            if constexpr (std::is_integral<T>::value) {
+                int64_t area = cross(::Vector<vertex<T>>(rect.vertices[0], rect.vertices[1]),
+                                       ::Vector<vertex<T>>(rect.vertices[1], rect.vertices[2]));
+                return area < 0 ? 0 - uint64_t(area) : uint64_t(area);
+            } else {
+                return rect.area();
+            }
+        }
+
+        void Reset(size_t id, const rectangle<T> &rect) {
+            Node &node = nodes_[id];
+            node.key = KeyOf(rect);
+            node.priority = random_();
+            node.left = node.right = kNone;
+            node.size = 1;
+            node.indexed = true;
+        }
+
+        // The node with the highest priority, which Build put at the top.
+        size_t FindRoot(const std::vector<size_t> &ids) const {
+            size_t root = ids.front();
+            for (size_t id : ids) {
+                if (nodes_[id].priority > nodes_[root].priority) {
+                    root = id;
+                }
+            }
+            return root;
+        }
+
+        size_t SizeOf(size_t node) const {
+            return node == kNone ? 0 : nodes_[node].size;
+        }
+
+        void Pull(size_t node) {
+            nodes_[node].size = 1 + SizeOf(nodes_[node].left) + SizeOf(nodes_[node].right);
+        }
+
+        bool Less(size_t node, Key key, size_t id) const {
+            return nodes_[node].key < key || (nodes_[node].key == key && node < id);
+        }
+
+        // Splits into the nodes ordered before (key, id) and the rest.
+        Children Split(size_t node, Key key, size_t id) {
+            if (node == kNone) {
+                return {kNone, kNone};
+            }
+            if (Less(node, key, id)) {
+                Children parts = Split(nodes_[node].right, key, id);
+                nodes_[node].right = parts.first;
+                Pull(node);
+                return {node, parts.second};
+            }
+            Children parts = Split(nodes_[node].left, key, id);
+            nodes_[node].left = parts.second;
+            Pull(node);
+            return {parts.first, node};
+        }
+
+        size_t Merge(size_t left, size_t right) {
+            if (left == kNone) {
+                return right;
+            }
+            if (right == kNone) {
+                return left;
+            }
+            if (nodes_[left].priority > nodes_[right].priority) {
+                nodes_[left].right = Merge(nodes_[left].right, right);
+                Pull(left);
+                return left;
+            }
+            nodes_[right].left = Merge(left, nodes_[right].left);
+            Pull(right);
+            return right;
+        }
+
+        size_t Erase(size_t node, Key key, size_t id) {
+            if (node == id) {
+                return Merge(nodes_[node].left, nodes_[node].right);
+            }
+            if (Less(node, key, id)) {
+                nodes_[node].right = Erase(nodes_[node].right, key, id);
+            } else {
+                nodes_[node].left = Erase(nodes_[node].left, key, id);
+            }
+            Pull(node);
+            return node;
+        }
+
+        size_t CountLess(Key key) const {
+            size_t count = 0;
+            for (size_t node = root_; node != kNone;) {
+                if (nodes_[node].key < key) {
+                    count += SizeOf(nodes_[node].left) + 1;
+                    node = nodes_[node].right;
+                } else {
+                    node = nodes_[node].left;
+                }
+            }
+            return count;
+        }
+
+        std::vector<Node> nodes_;
+        size_t root_ = kNone;
+        std::minstd_rand random_;
+    };
+
+}
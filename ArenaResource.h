@@ -0,0 +1,101 @@
+#pragma once
+
+#include <memory_resource>
+#include "Allocator.h"
+
+namespace Allocators {
+
+    // An arena as a std::pmr::memory_resource, so one arena can back several
+    // containers: std::pmr containers take a pointer to it directly, the project
+    // containers take an ArenaAllocator handle.
+    template<typename FitPolicy = SegregatedFit, typename GrowthPolicy = GeometricGrowth>
+    class ArenaResource : public std::pmr::memory_resource {
+    public:
+        explicit ArenaResource(size_t size) : arena_(size) {}
+
+        bool TryResize(void *ptr, size_t bytes) {
+            return arena_.TryResize(ptr, bytes);
+        }
+
+        ArenaStats GetStats() const {
+            return arena_.GetStats();
+        }
+
+    private:
+        void *do_allocate(size_t bytes, size_t alignment) override {
+            return arena_.Allocate(bytes, alignment);
+        }
+
+        void do_deallocate(void *ptr, size_t, size_t) override {
+            arena_.Deallocate(ptr);
+        }
+
+        bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override {
+            return this == &other;
+        }
+
+        Arena<FitPolicy, GrowthPolicy> arena_;
+    };
+
+    // Copyable allocator that only points at a resource owned elsewhere. Copies and
+    // rebinds share the resource, and memory from one of them may be freed by another.
+    template<typename T, typename Resource = ArenaResource<>>
+    class ArenaAllocator {
+    public:
+        using value_type = T;
+        using size_type = std::size_t;
+        using difference_type = std::ptrdiff_t;
+        using is_always_equal = std::false_type;
+        using propagate_on_container_copy_assignment = std::true_type;
+        using propagate_on_container_move_assignment = std::true_type;
+        using propagate_on_container_swap = std::true_type;
+
+        template<class V>
+        struct rebind {
+            using other = ArenaAllocator<V, Resource>;
+        };
+
+        ArenaAllocator(Resource *resource) : resource_(resource) {}
+
+        template<typename V>
+        ArenaAllocator(const ArenaAllocator<V, Resource> &other) : resource_(other.resource()) {}
+
+        T *allocate(size_t mem_size) {
+            return static_cast<T *>(resource_->allocate(mem_size * sizeof(T), alignof(T)));
+        }
+
+        T *allocate_aligned(size_t mem_size, size_t alignment) {
+            return static_cast<T *>(resource_->allocate(mem_size * sizeof(T), std::max(alignment, alignof(T))));
+        }
+
+        void deallocate(T *typed_ptr, size_t mem_size) {
+            resource_->deallocate(typed_ptr, mem_size * sizeof(T), alignof(T));
+        }
+
+        void deallocate_aligned(T *typed_ptr, size_t mem_size, size_t alignment) {
+            resource_->deallocate(typed_ptr, mem_size * sizeof(T), std::max(alignment, alignof(T)));
+        }
+
+        bool try_expand(T *typed_ptr, size_t mem_size) {
+            return resource_->TryResize(typed_ptr, mem_size * sizeof(T));
+        }
+
+        Resource *resource() const {
+            return resource_;
+        }
+
+    private:
+        Resource *resource_;
+    };
+
+    template<typename T, typename V, typename Resource>
+    bool operator==(const ArenaAllocator<T, Resource> &lhs, const ArenaAllocator<V, Resource> &rhs) {
+        return lhs.resource() == rhs.resource();
+    }
+
+    template<typename T, typename V, typename Resource>
+    bool operator!=(const ArenaAllocator<T, Resource> &lhs, const ArenaAllocator<V, Resource> &rhs) {
+        return !(lhs == rhs);
+    }
+
+}
@@ -0,0 +1,200 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <mutex>
+#include "Allocator.h"
+
+namespace Allocators {
+
+    // Allocator that may be called from several threads at once. Small requests are
+    // served from per-thread caches of ready blocks, sorted by 16-byte size class.
+    // A cache that runs dry takes a batch from the depot of its class, and only then
+    // goes to the shared arena; a cache that overflows gives a batch back to the depot.
+    // Frees from any thread land in the caller's cache, so remote frees need no extra
+    // path. Every cache, depot and the arena have their own lock.
+    template<typename T, size_t ALLOC_SIZE, typename FitPolicy = SegregatedFit>
+    class ConcurrentAllocator {
+    public:
+        using value_type = T;
+        using size_type = std::size_t;
+        using difference_type = std::ptrdiff_t;
+        using is_always_equal = std::false_type;
+
+        ConcurrentAllocator(const ConcurrentAllocator &) = delete;
+
+        ConcurrentAllocator(ConcurrentAllocator &&) = delete;
+
+        template<class V>
+        struct rebind {
+            using other = ConcurrentAllocator<V, ALLOC_SIZE, FitPolicy>;
+        };
+
+        ConcurrentAllocator() : arena_(ALLOC_SIZE) {}
+
+        T *allocate(size_t mem_size) {
+            size_t bytes = mem_size * sizeof(T);
+            if (bytes > kMaxCachedSize || alignof(T) > Block::kAlignment) {
+                std::lock_guard<std::mutex> lock(arena_mutex_);
+                T *ptr = static_cast<T *>(arena_.Allocate(bytes, alignof(T)));
+                arena_calls_.OnAllocate();
+                return ptr;
+            }
+            size_t size_class = ClassOf(bytes);
+            Cache &cache = caches_[CacheIndex()];
+            std::lock_guard<std::mutex> lock(cache.mutex);
+            Magazine &magazine = cache.magazines[size_class];
+            if (magazine.Empty()) {
+                Refill(magazine, size_class);
+            }
+            cache.calls.OnAllocate();
+            return static_cast<T *>(magazine.Pop());
+        }
+
+        // Aligned blocks bypass the caches, they are served by the arena directly and
+        // must be freed with deallocate_aligned, which gives them back to it.
+        T *allocate_aligned(size_t mem_size, size_t alignment) {
+            std::lock_guard<std::mutex> lock(arena_mutex_);
+            T *ptr = static_cast<T *>(arena_.Allocate(mem_size * sizeof(T), std::max(alignment, alignof(T))));
+            arena_calls_.OnAllocate();
+            return ptr;
+        }
+
+        void deallocate(T *typed_ptr, size_t mem_size) {
+            size_t bytes = mem_size * sizeof(T);
+            if (bytes > kMaxCachedSize || alignof(T) > Block::kAlignment) {
+                std::lock_guard<std::mutex> lock(arena_mutex_);
+                arena_.Deallocate(typed_ptr);
+                arena_calls_.OnDeallocate();
+                return;
+            }
+            size_t size_class = ClassOf(bytes);
+            Cache &cache = caches_[CacheIndex()];
+            std::lock_guard<std::mutex> lock(cache.mutex);
+            Magazine &magazine = cache.magazines[size_class];
+            magazine.Push(typed_ptr);
+            cache.calls.OnDeallocate();
+            if (magazine.count > 2 * kBatchSize) {
+                Depot &depot = depots_[size_class];
+                std::lock_guard<std::mutex> depot_lock(depot.mutex);
+                magazine.MoveTo(depot.blocks, kBatchSize);
+            }
+        }
+
+        void deallocate_aligned(T *typed_ptr, size_t, size_t) {
+            std::lock_guard<std::mutex> lock(arena_mutex_);
+            arena_.Deallocate(typed_ptr);
+            arena_calls_.OnDeallocate();
+        }
+
+        // Call counts are those of allocate and deallocate, kept per cache. Everything
+        // else is what the arena sees: blocks parked in the thread caches and depots
+        // count as in use, and latencies are those of the batch refills.
+        ArenaStats GetStats() {
+            ArenaStats stats;
+            {
+                std::lock_guard<std::mutex> lock(arena_mutex_);
+                stats = arena_.GetStats();
+                stats.allocations = 0;
+                stats.deallocations = 0;
+                arena_calls_.AddTo(stats);
+            }
+            for (Cache &cache : caches_) {
+                std::lock_guard<std::mutex> lock(cache.mutex);
+                cache.calls.AddTo(stats);
+            }
+            return stats;
+        }
+
+    private:
+        static constexpr size_t kClassStep = Block::kAlignment;
+        static constexpr size_t kClassesCount = 16;
+        static constexpr size_t kMaxCachedSize = kClassStep * kClassesCount;
+        static constexpr size_t kBatchSize = 32;
+        static constexpr size_t kCachesCount = 32;
+
+        // Free blocks of one size class chained through their payloads.
+        struct Magazine {
+            struct Node {
+                Node *next;
+            };
+
+            bool Empty() const {
+                return head == nullptr;
+            }
+
+            void Push(void *ptr) {
+                Node *node = static_cast<Node *>(ptr);
+                node->next = head;
+                head = node;
+                ++count;
+            }
+
+            void *Pop() {
+                Node *node = head;
+                head = node->next;
+                --count;
+                return node;
+            }
+
+            void MoveTo(Magazine &other, size_t amount) {
+                while (amount-- > 0 && !Empty()) {
+                    other.Push(Pop());
+                }
+            }
+
+            Node *head = nullptr;
+            size_t count = 0;
+        };
+
+        struct alignas(64) Cache {
+            std::mutex mutex;
+            std::array<Magazine, kClassesCount> magazines;
+            CallCounters calls;
+        };
+
+        struct alignas(64) Depot {
+            std::mutex mutex;
+            Magazine blocks;
+        };
+
+        static size_t ClassOf(size_t bytes) {
+            return bytes == 0 ? 0 : (bytes - 1) / kClassStep;
+        }
+
+        static size_t CacheIndex() {
+            static std::atomic<size_t> next_index{0};
+            thread_local size_t index = next_index++ % kCachesCount;
+            return index;
+        }
+
+        void Refill(Magazine &magazine, size_t size_class) {
+            {
+                Depot &depot = depots_[size_class];
+                std::lock_guard<std::mutex> lock(depot.mutex);
+                depot.blocks.MoveTo(magazine, kBatchSize);
+            }
+            if (!magazine.Empty()) {
+                return;
+            }
+            std::lock_guard<std::mutex> lock(arena_mutex_);
+            for (size_t i = 0; i < kBatchSize; ++i) {
+                try {
+                    magazine.Push(arena_.Allocate((size_class + 1) * kClassStep));
+                } catch (const std::runtime_error &) {
+                    if (magazine.Empty()) {
+                        throw;
+                    }
+                    break;
+                }
+            }
+        }
+
+        Arena<FitPolicy> arena_;
+        std::mutex arena_mutex_;
+        CallCounters arena_calls_;
+        std::array<Cache, kCachesCount> caches_;
+        std::array<Depot, kClassesCount> depots_;
+    };
+
+}
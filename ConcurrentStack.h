@@ -0,0 +1,165 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <thread>
+
+namespace Containers {
+
+    // next is written only before the node is published; popped nodes are chained
+    // through retired_next, since other threads may still read next.
+    template <typename T>
+    struct ConcurrentStackNode {
+        T data;
+        ConcurrentStackNode* next;
+        ConcurrentStackNode* retired_next;
+    };
+
+    // Treiber stack: Push and TryPop swing the head with compare-and-swap, so any
+    // number of threads can use it at once. A popped node is only freed once no
+    // thread holds a hazard pointer to it. The allocator is called from every
+    // thread that pushes or pops, so it must be thread safe itself (std::allocator,
+    // Allocators::ConcurrentAllocator, ...).
+    template <typename T, typename Allocator = std::allocator<T>>
+    class ConcurrentStack {
+    public:
+        using Node = ConcurrentStackNode<T>;
+        using allocator_type = typename Allocator::template rebind<Node>::other;
+
+        ConcurrentStack() = default;
+
+        explicit ConcurrentStack(const Allocator &allocator) : allocator_(allocator) {}
+
+        ConcurrentStack(const ConcurrentStack&) = delete;
+        ConcurrentStack(ConcurrentStack&&) = delete;
+
+        ~ConcurrentStack() {
+            for (Node* node = head_.load(std::memory_order_relaxed); node != nullptr;) {
+                Node* next = node->next;
+                DeleteNode(node);
+                node = next;
+            }
+            for (HazardSlot& slot : slots_) {
+                for (Node* node = slot.retired; node != nullptr;) {
+                    Node* next = node->retired_next;
+                    DeleteNode(node);
+                    node = next;
+                }
+            }
+        }
+
+        bool Empty() const {
+            return head_.load(std::memory_order_acquire) == nullptr;
+        }
+
+        void Push(T elem) {
+            Node* node = allocator_.allocate(1);
+            try {
+                new (node) Node{std::move(elem), nullptr, nullptr};
+            } catch (...) {
+                allocator_.deallocate(node, 1);
+                throw;
+            }
+            node->next = head_.load(std::memory_order_relaxed);
+            while (!head_.compare_exchange_weak(node->next, node, std::memory_order_release,
+                                                std::memory_order_relaxed)) {}
+        }
+
+        // Moves the top element into out; returns false if the stack was empty.
+        bool TryPop(T& out) {
+            HazardSlot& slot = AcquireSlot();
+            Node* node = head_.load(std::memory_order_acquire);
+            while (node != nullptr) {
+                slot.hazard.store(node);
+                if (head_.load() != node) {
+                    node = head_.load(std::memory_order_acquire);
+                    continue;
+                }
+                if (head_.compare_exchange_weak(node, node->next, std::memory_order_acq_rel,
+                                                std::memory_order_acquire)) {
+                    break;
+                }
+            }
+            slot.hazard.store(nullptr, std::memory_order_release);
+            if (node != nullptr) {
+                out = std::move(node->data);
+                Retire(slot, node);
+            }
+            slot.busy.store(false, std::memory_order_release);
+            return node != nullptr;
+        }
+
+    private:
+        static constexpr size_t kSlotsCount = 64;
+        static constexpr size_t kScanThreshold = 2 * kSlotsCount;
+
+        // A popping thread owns one slot for the duration of the call: the slot
+        // publishes the node it is about to read and keeps the nodes it retired.
+        struct alignas(64) HazardSlot {
+            std::atomic<bool> busy{false};
+            std::atomic<Node*> hazard{nullptr};
+            Node* retired = nullptr;
+            size_t retired_count = 0;
+        };
+
+        HazardSlot& AcquireSlot() {
+            size_t start = std::hash<std::thread::id>()(std::this_thread::get_id());
+            for (size_t i = 0;; ++i) {
+                HazardSlot& slot = slots_[(start + i) % kSlotsCount];
+                if (!slot.busy.load(std::memory_order_relaxed) &&
+                    !slot.busy.exchange(true, std::memory_order_acquire)) {
+                    return slot;
+                }
+                if (i % kSlotsCount == kSlotsCount - 1) {
+                    std::this_thread::yield();
+                }
+            }
+        }
+
+        void Retire(HazardSlot& slot, Node* node) {
+            node->retired_next = slot.retired;
+            slot.retired = node;
+            if (++slot.retired_count >= kScanThreshold) {
+                Scan(slot);
+            }
+        }
+
+        // Frees every retired node of the slot that no thread has published.
+        void Scan(HazardSlot& slot) {
+            std::array<Node*, kSlotsCount> hazards;
+            for (size_t i = 0; i < kSlotsCount; ++i) {
+                hazards[i] = slots_[i].hazard.load();
+            }
+            std::sort(hazards.begin(), hazards.end());
+            Node* node = slot.retired;
+            slot.retired = nullptr;
+            slot.retired_count = 0;
+            while (node != nullptr) {
+                Node* next = node->retired_next;
+                if (std::binary_search(hazards.begin(), hazards.end(), node)) {
+                    node->retired_next = slot.retired;
+                    slot.retired = node;
+                    ++slot.retired_count;
+                } else {
+                    DeleteNode(node);
+                }
+                node = next;
+            }
+        }
+
+        void DeleteNode(Node* node) {
+            node->~Node();
+            allocator_.deallocate(node, 1);
+        }
+
+        allocator_type allocator_;
+        alignas(64) std::atomic<Node*> head_{nullptr};
+        std::array<HazardSlot, kSlotsCount> slots_;
+    };
+
+}
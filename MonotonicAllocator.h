@@ -0,0 +1,139 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <stdexcept>
+#include "Allocator.h"
+
+namespace Allocators {
+
+    // Bump-pointer arena for request-scoped work: Allocate moves a cursor, Deallocate
+    // does nothing, and Reset rewinds the cursor to the first chunk in one step. Chunks
+    // added by growth are kept across Reset and filled again before any new malloc.
+    template<typename GrowthPolicy = GeometricGrowth>
+    class MonotonicArena {
+    public:
+        explicit MonotonicArena(size_t size) : chunk_size_(size), initial_size_(size) {
+            first_ = AddChunk(size);
+            Enter(first_);
+        }
+
+        ~MonotonicArena() {
+            while (first_ != nullptr) {
+                Chunk *next = first_->next;
+                free(first_);
+                first_ = next;
+            }
+        }
+
+        MonotonicArena(const MonotonicArena &) = delete;
+
+        MonotonicArena(MonotonicArena &&) = delete;
+
+        void *Allocate(size_t bytes, size_t alignment) {
+            if (bytes > SIZE_MAX / 4) {
+                throw std::runtime_error("No memory");
+            }
+            while (true) {
+                char *ptr = AlignUp(cursor_, alignment);
+                if (ptr <= end_ && bytes <= size_t(end_ - ptr)) {
+                    cursor_ = ptr + bytes;
+                    return ptr;
+                }
+                if (current_->next == nullptr) {
+                    size_t capacity = GrowthPolicy::NextChunkSize(initial_size_, chunk_size_, bytes + alignment);
+                    if (capacity < bytes + alignment) {
+                        throw std::runtime_error("No memory");
+                    }
+                    current_->next = AddChunk(capacity);
+                    chunk_size_ = capacity;
+                }
+                Enter(current_->next);
+            }
+        }
+
+        void Deallocate(void *) {}
+
+        // Every pointer handed out before is invalid afterwards; objects living in the
+        // arena are not destroyed.
+        void Reset() {
+            Enter(first_);
+        }
+
+    private:
+        struct Chunk {
+            Chunk *next;
+            size_t capacity;
+        };
+
+        static char *AlignUp(char *ptr, size_t alignment) {
+            uintptr_t value = reinterpret_cast<uintptr_t>(ptr);
+            return ptr + (alignment - value % alignment) % alignment;
+        }
+
+        static Chunk *AddChunk(size_t capacity) {
+            Chunk *chunk = (Chunk *) malloc(sizeof(Chunk) + capacity);
+            if (chunk == nullptr) {
+                throw std::runtime_error("No memory");
+            }
+            chunk->next = nullptr;
+            chunk->capacity = capacity;
+            return chunk;
+        }
+
+        void Enter(Chunk *chunk) {
+            current_ = chunk;
+            cursor_ = reinterpret_cast<char *>(chunk + 1);
+            end_ = cursor_ + chunk->capacity;
+        }
+
+        Chunk *first_;
+        Chunk *current_;
+        char *cursor_;
+        char *end_;
+        size_t chunk_size_;
+        size_t initial_size_;
+    };
+
+    template<typename T, size_t ALLOC_SIZE, typename GrowthPolicy = GeometricGrowth>
+    class MonotonicAllocator {
+    public:
+        using value_type = T;
+        using size_type = std::size_t;
+        using difference_type = std::ptrdiff_t;
+        using is_always_equal = std::false_type;
+
+        MonotonicAllocator(const MonotonicAllocator &) = delete;
+
+        MonotonicAllocator(MonotonicAllocator &&) = delete;
+
+        template<class V>
+        struct rebind {
+            using other = MonotonicAllocator<V, ALLOC_SIZE, GrowthPolicy>;
+        };
+
+        MonotonicAllocator() : arena_(ALLOC_SIZE) {}
+
+        T *allocate(size_t mem_size) {
+            return static_cast<T *>(arena_.Allocate(mem_size * sizeof(T), alignof(T)));
+        }
+
+        T *allocate_aligned(size_t mem_size, size_t alignment) {
+            return static_cast<T *>(arena_.Allocate(mem_size * sizeof(T), std::max(alignment, alignof(T))));
+        }
+
+        void deallocate(T *, size_t) {}
+
+        void deallocate_aligned(T *, size_t, size_t) {}
+
+        void Reset() {
+            arena_.Reset();
+        }
+
+    private:
+
+        MonotonicArena<GrowthPolicy> arena_;
+    };
+
+}
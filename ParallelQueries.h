@@ -0,0 +1,107 @@
+#pragma once
+
+#include <algorithm>
+#include <iterator>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+#include "ThreadPool.h"
+#include "vertex.h"
+
+namespace Parallel {
+
+    // Elements per chunk: large enough that taking a chunk costs nothing next to
+    // processing it, small enough to keep every thread busy to the end.
+    constexpr size_t kDefaultGrain = 4096;
+
+    // Maps every chunk of [first, last) to a partial result with map(chunk_first,
+    // chunk_last) and folds the partials with combine in chunk order, so the result
+    // does not depend on the number of threads.
+    template<typename Result, typename RandomIt, typename Map, typename Combine>
+    Result MapReduce(ThreadPool &pool, RandomIt first, RandomIt last, Result init, Map map, Combine combine,
+                     size_t grain = kDefaultGrain) {
+        grain = std::max<size_t>(grain, 1);
+        size_t count = std::distance(first, last);
+        std::vector<Result> partials((count + grain - 1) / grain, init);
+        pool.ParallelFor(count, grain, [&](size_t begin, size_t end) {
+            partials[begin / grain] = map(first + begin, first + end);
+        });
+        for (const Result &partial : partials) {
+            init = combine(init, partial);
+        }
+        return init;
+    }
+
+    template<typename RandomIt, typename Predicate>
+    size_t CountIf(ThreadPool &pool, RandomIt first, RandomIt last, Predicate pred) {
+        return MapReduce(pool, first, last, size_t(0),
+                         [&](RandomIt begin, RandomIt end) { return size_t(std::count_if(begin, end, pred)); },
+                         [](size_t lhs, size_t rhs) { return lhs + rhs; });
+    }
+
+    struct AreaSummary {
+        size_t count = 0;
+        double sum = 0;
+        double min = std::numeric_limits<double>::infinity();
+        double max = -std::numeric_limits<double>::infinity();
+
+        void Add(double area) {
+            ++count;
+            sum += area;
+            min = std::min(min, area);
+            max = std::max(max, area);
+        }
+
+        AreaSummary &operator+=(const AreaSummary &other) {
+            count += other.count;
+            sum += other.sum;
+            min = std::min(min, other.min);
+            max = std::max(max, other.max);
+            return *this;
+        }
+    };
+
+    // Sum, minimum and maximum of area() over the figures of the range that exist;
+    // unfilled slots are skipped. min and max stay infinite when there is none.
+    template<typename RandomIt>
+    AreaSummary Areas(ThreadPool &pool, RandomIt first, RandomIt last) {
+        return MapReduce(pool, first, last, AreaSummary(),
+                         [](RandomIt begin, RandomIt end) {
+                             AreaSummary summary;
+                             for (; begin != end; ++begin) {
+                                 if (begin->existance) {
+                                     summary.Add(begin->area());
+                                 }
+                             }
+                             return summary;
+                         },
+                         [](AreaSummary lhs, const AreaSummary &rhs) { return lhs += rhs; });
+    }
+
+    // Mean of the centers of the figures in the range that exist.
+    template<typename RandomIt>
+    vertex<double> Centroid(ThreadPool &pool, RandomIt first, RandomIt last) {
+        using Partial = std::pair<vertex<double>, size_t>;
+        Partial sum = MapReduce(pool, first, last, Partial({0, 0}, 0),
+                                [](RandomIt begin, RandomIt end) {
+                                    Partial partial({0, 0}, 0);
+                                    for (; begin != end; ++begin) {
+                                        if (begin->existance) {
+                                            partial.first = partial.first + begin->center();
+                                            ++partial.second;
+                                        }
+                                    }
+                                    return partial;
+                                },
+                                [](Partial lhs, const Partial &rhs) {
+                                    return Partial(lhs.first + rhs.first, lhs.second + rhs.second);
+                                });
+        if (sum.second == 0) {
+            throw std::logic_error("Centroid of empty range");
+        }
+        double count = double(sum.second);
+        return vertex<double>{sum.first.x / count, sum.first.y / count};
+    }
+
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <cstdlib>
+#include <stdexcept>
+#include <type_traits>
+
+namespace Allocators {
+
+    // Fixed-size slots for node based containers, which only ever ask for one object at
+    // a time. Freed slots are chained through their own storage, so allocate and
+    // deallocate are a pop and a push. Slots that were never handed out are taken
+    // from the end of the buffer, so nothing is walked at construction time.
+    template<typename T, size_t SLOTS_COUNT>
+    class PoolAllocator {
+    public:
+        using value_type = T;
+        using size_type = std::size_t;
+        using difference_type = std::ptrdiff_t;
+        using is_always_equal = std::false_type;
+
+        PoolAllocator(const PoolAllocator &) = delete;
+
+        PoolAllocator(PoolAllocator &&) = delete;
+
+        template<class V>
+        struct rebind {
+            using other = PoolAllocator<V, SLOTS_COUNT>;
+        };
+
+        PoolAllocator() {
+            data = static_cast<Slot *>(std::aligned_alloc(alignof(Slot), SLOTS_COUNT * sizeof(Slot)));
+            if (data == nullptr) {
+                throw std::runtime_error("No memory");
+            }
+        }
+
+        ~PoolAllocator() {
+            std::free(data);
+        }
+
+        T *allocate(size_t mem_size) {
+            if (mem_size != 1) {
+                throw std::runtime_error("Pool serves one object at a time");
+            }
+            Slot *slot = free_list;
+            if (slot != nullptr) {
+                free_list = slot->next;
+            } else if (untouched < SLOTS_COUNT) {
+                slot = data + untouched++;
+            } else {
+                throw std::runtime_error("No memory");
+            }
+            return reinterpret_cast<T *>(slot->storage);
+        }
+
+        void deallocate(T *typed_ptr, size_t) {
+            Slot *slot = reinterpret_cast<Slot *>(typed_ptr);
+            if (slot < data || slot >= data + untouched) {
+                throw std::runtime_error("Wrong ptr to deallocate");
+            }
+            slot->next = free_list;
+            free_list = slot;
+        }
+
+    private:
+
+        union Slot {
+            Slot *next;
+            alignas(T) char storage[sizeof(T)];
+        };
+
+        Slot *data;
+        Slot *free_list = nullptr;
+        size_t untouched = 0;
+    };
+
+}
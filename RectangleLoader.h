@@ -0,0 +1,204 @@
+#pragma once
+
+#include <algorithm>
+#include <charconv>
+#include <cstdint>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <vector>
+#include "ParallelQueries.h"
+#include "Vector.h"
+#include "rectangle.h"
+
+namespace Containers {
+
+    // Bulk reader for text files of rectangles: eight numbers per rectangle, the
+    // same layout rectangle(std::istream&) reads, separated by any mix of spaces,
+    // tabs and line breaks (CRLF included). The file is read in large blocks, each
+    // cut at whitespace into pieces parsed with std::from_chars, on the threads of
+    // a pool if one is given. Rectangles are then validated and their geometry
+    // computed in parallel as well. Results do not depend on the number of threads.
+    template<typename T>
+    class RectangleLoader {
+    public:
+        explicit RectangleLoader(Parallel::ThreadPool *pool = nullptr) : pool_(pool) {}
+
+        // Appends the rectangles of the file at path to out and returns how many
+        // there were. Throws std::runtime_error if the file can't be read or holds
+        // something other than numbers, std::logic_error with the message of
+        // rectangle(std::istream&) for the first quad that is not a rectangle; out
+        // is left as it was in both cases.
+        template<typename Allocator, size_t INLINE_CAPACITY>
+        size_t Load(const std::string &path, Vector<rectangle<T>, Allocator, INLINE_CAPACITY> &out) {
+            std::ifstream file(path, std::ios::binary);
+            if (!file) {
+                throw std::runtime_error("Can't open file " + path);
+            }
+            size_t initial_size = out.Size();
+            try {
+                Read(file, out);
+            } catch (...) {
+                out.Resize(initial_size);
+                throw;
+            }
+            return out.Size() - initial_size;
+        }
+
+    private:
+        static constexpr size_t kBlockSize = size_t(1) << 24;
+        static constexpr size_t kPiecesPerThread = 4;
+        static constexpr size_t kNone = SIZE_MAX;
+
+        struct Piece {
+            size_t begin = 0;
+            size_t end = 0;
+            std::vector<T> numbers;
+            size_t error = kNone;
+        };
+
+        static bool IsSpace(char c) {
+            return c == ' ' || (c >= '\t' && c <= '\r');
+        }
+
+        template<typename Body>
+        void For(size_t count, size_t grain, const Body &body) {
+            if (pool_ != nullptr) {
+                pool_->ParallelFor(count, grain, body);
+            } else if (count != 0) {
+                body(0, count);
+            }
+        }
+
+        template<typename Allocator, size_t INLINE_CAPACITY>
+        void Read(std::ifstream &file, Vector<rectangle<T>, Allocator, INLINE_CAPACITY> &out) {
+            std::vector<char> buffer(kBlockSize);
+            size_t filled = 0;
+            size_t offset = 0;
+            numbers_.clear();
+            while (true) {
+                file.read(buffer.data() + filled, std::streamsize(buffer.size() - filled));
+                filled += size_t(file.gcount());
+                bool last = !file;
+                if (last && !file.eof()) {
+                    throw std::runtime_error("Can't read file");
+                }
+                // The block ends at its last whitespace; the rest goes to the next one.
+                size_t cut = filled;
+                if (!last) {
+                    while (cut != 0 && !IsSpace(buffer[cut - 1])) {
+                        --cut;
+                    }
+                    if (cut == 0) {
+                        buffer.resize(2 * buffer.size());
+                        continue;
+                    }
+                }
+                Parse(buffer.data(), cut, offset);
+                Assemble(out);
+                std::copy(buffer.begin() + cut, buffer.begin() + filled, buffer.begin());
+                filled -= cut;
+                offset += cut;
+                if (last) {
+                    break;
+                }
+            }
+            if (!numbers_.empty()) {
+                throw std::runtime_error("Incomplete rectangle at the end of the file");
+            }
+        }
+
+        // Parses text[0, size) into numbers_, after the numbers left over from the
+        // previous block. offset is the position of text in the file.
+        void Parse(const char *text, size_t size, size_t offset) {
+            pieces_.resize(pool_ != nullptr ? pool_->Size() * kPiecesPerThread : 1);
+            size_t begin = 0;
+            for (size_t i = 0; i < pieces_.size(); ++i) {
+                size_t end = i + 1 == pieces_.size() ? size : std::max(begin, size / pieces_.size() * (i + 1));
+                while (end != size && !IsSpace(text[end])) {
+                    ++end;
+                }
+                pieces_[i].begin = begin;
+                pieces_[i].end = end;
+                begin = end;
+            }
+            For(pieces_.size(), 1, [&](size_t first, size_t last) {
+                for (size_t i = first; i < last; ++i) {
+                    ParsePiece(text, pieces_[i]);
+                }
+            });
+            for (const Piece &piece : pieces_) {
+                if (piece.error != kNone) {
+                    throw std::runtime_error("Malformed number at byte " + std::to_string(offset + piece.error));
+                }
+                numbers_.insert(numbers_.end(), piece.numbers.begin(), piece.numbers.end());
+            }
+        }
+
+        static void ParsePiece(const char *text, Piece &piece) {
+            piece.numbers.clear();
+            piece.error = kNone;
+            const char *p = text + piece.begin;
+            const char *end = text + piece.end;
+            while (true) {
+                while (p != end && IsSpace(*p)) {
+                    ++p;
+                }
+                if (p == end) {
+                    return;
+                }
+                // operator>> accepts an explicit plus sign, std::from_chars does not.
+                const char *start = p;
+                if (*p == '+' && p + 1 != end && *(p + 1) != '-') {
+                    ++p;
+                }
+                T value;
+                std::from_chars_result result = std::from_chars(p, end, value);
+                if (result.ec != std::errc() || (result.ptr != end && !IsSpace(*result.ptr))) {
+                    piece.error = size_t(start - text);
+                    return;
+                }
+                piece.numbers.push_back(value);
+                p = result.ptr;
+            }
+        }
+
+        // Turns every complete group of eight numbers into a rectangle appended to out.
+        template<typename Allocator, size_t INLINE_CAPACITY>
+        void Assemble(Vector<rectangle<T>, Allocator, INLINE_CAPACITY> &out) {
+            size_t count = numbers_.size() / 8;
+            if (count == 0) {
+                return;
+            }
+            size_t first_id = out.Size();
+            out.Resize(first_id + count);
+            statuses_.resize(count);
+            rectangle<T> *target = &out[first_id];
+            For(count, Parallel::kDefaultGrain, [&](size_t first, size_t last) {
+                for (size_t i = first; i < last; ++i) {
+                    vertex<T> quad[4];
+                    for (size_t v = 0; v < 4; ++v) {
+                        quad[v] = {numbers_[8 * i + 2 * v], numbers_[8 * i + 2 * v + 1]};
+                    }
+                    statuses_[i] = validate_rectangle(quad);
+                    if (statuses_[i] == rectangle_status::valid) {
+                        target[i] = rectangle<T>(quad);
+                    }
+                }
+            });
+            for (rectangle_status status : statuses_) {
+                if (status != rectangle_status::valid) {
+                    throw std::logic_error(rectangle_status_message(status));
+                }
+            }
+            numbers_.erase(numbers_.begin(), numbers_.begin() + 8 * count);
+        }
+
+        Parallel::ThreadPool *pool_;
+        std::vector<Piece> pieces_;
+        std::vector<T> numbers_;
+        std::vector<rectangle_status> statuses_;
+    };
+
+}
@@ -0,0 +1,248 @@
+#ifndef D_RECTANGLE_SET_H_
+#define D_RECTANGLE_SET_H_ 1
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <type_traits>
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "rectangle.h"
+
+// One double per lane; the kernels below are written once against this interface.
+struct ScalarPack {
+	static constexpr size_t width = 1;
+	double v;
+
+	static ScalarPack load(const double* p) { return {*p}; }
+	static ScalarPack broadcast(double d) { return {d}; }
+	void store(double* p) const { *p = v; }
+
+	friend ScalarPack operator+(ScalarPack a, ScalarPack b) { return {a.v + b.v}; }
+	friend ScalarPack operator-(ScalarPack a, ScalarPack b) { return {a.v - b.v}; }
+	friend ScalarPack operator*(ScalarPack a, ScalarPack b) { return {a.v * b.v}; }
+	friend ScalarPack sqrt(ScalarPack a) { return {std::sqrt(a.v)}; }
+	friend ScalarPack trunc(ScalarPack a) { return {std::trunc(a.v)}; }
+	friend size_t count_less(ScalarPack a, ScalarPack b) { return a.v < b.v; }
+};
+
+#if defined(__AVX__)
+struct SimdPack {
+	static constexpr size_t width = 4;
+	__m256d v;
+
+	static SimdPack load(const double* p) { return {_mm256_load_pd(p)}; }
+	static SimdPack broadcast(double d) { return {_mm256_set1_pd(d)}; }
+	void store(double* p) const { _mm256_storeu_pd(p, v); }
+
+	friend SimdPack operator+(SimdPack a, SimdPack b) { return {_mm256_add_pd(a.v, b.v)}; }
+	friend SimdPack operator-(SimdPack a, SimdPack b) { return {_mm256_sub_pd(a.v, b.v)}; }
+	friend SimdPack operator*(SimdPack a, SimdPack b) { return {_mm256_mul_pd(a.v, b.v)}; }
+	friend SimdPack sqrt(SimdPack a) { return {_mm256_sqrt_pd(a.v)}; }
+	friend SimdPack trunc(SimdPack a) { return {_mm256_round_pd(a.v, _MM_FROUND_TO_ZERO | _MM_FROUND_NO_EXC)}; }
+	friend size_t count_less(SimdPack a, SimdPack b) {
+		return __builtin_popcount(_mm256_movemask_pd(_mm256_cmp_pd(a.v, b.v, _CMP_LT_OQ)));
+	}
+};
+#elif defined(__SSE2__)
+struct SimdPack {
+	static constexpr size_t width = 2;
+	__m128d v;
+
+	static SimdPack load(const double* p) { return {_mm_load_pd(p)}; }
+	static SimdPack broadcast(double d) { return {_mm_set1_pd(d)}; }
+	void store(double* p) const { _mm_storeu_pd(p, v); }
+
+	friend SimdPack operator+(SimdPack a, SimdPack b) { return {_mm_add_pd(a.v, b.v)}; }
+	friend SimdPack operator-(SimdPack a, SimdPack b) { return {_mm_sub_pd(a.v, b.v)}; }
+	friend SimdPack operator*(SimdPack a, SimdPack b) { return {_mm_mul_pd(a.v, b.v)}; }
+	friend SimdPack sqrt(SimdPack a) { return {_mm_sqrt_pd(a.v)}; }
+	// SSE2 has no rounding instruction. Below 2^52, adding and subtracting 2^52
+	// rounds the magnitude to an integer, which is stepped down if it went up;
+	// larger magnitudes are integers already. The sign is put back at the end.
+	friend SimdPack trunc(SimdPack a) {
+		__m128d sign = _mm_set1_pd(-0.0);
+		__m128d magic = _mm_set1_pd(4503599627370496.0);
+		__m128d magnitude = _mm_andnot_pd(sign, a.v);
+		__m128d rounded = _mm_sub_pd(_mm_add_pd(magnitude, magic), magic);
+		rounded = _mm_sub_pd(rounded, _mm_and_pd(_mm_cmpgt_pd(rounded, magnitude), _mm_set1_pd(1.0)));
+		__m128d small = _mm_cmplt_pd(magnitude, magic);
+		rounded = _mm_or_pd(_mm_and_pd(small, rounded), _mm_andnot_pd(small, magnitude));
+		return {_mm_or_pd(rounded, _mm_and_pd(sign, a.v))};
+	}
+	friend size_t count_less(SimdPack a, SimdPack b) {
+		return __builtin_popcount(_mm_movemask_pd(_mm_cmplt_pd(a.v, b.v)));
+	}
+};
+#else
+using SimdPack = ScalarPack;
+#endif
+
+// Rectangles stored column-wise: each vertex coordinate has its own array of
+// doubles, so the bulk queries stream through memory and use all SIMD lanes
+// (AVX when the compiler targets it, SSE2 otherwise). Columns are 32-byte
+// aligned and padded to a multiple of four elements. The results equal those
+// of rectangle::area and rectangle::center for every element while squared side
+// lengths stay below 2^53, where double arithmetic is still exact.
+template<class T>
+class RectangleSet {
+public:
+	RectangleSet() = default;
+	RectangleSet(const RectangleSet&) = delete;
+	RectangleSet& operator=(const RectangleSet&) = delete;
+
+	~RectangleSet() {
+		std::free(data);
+	}
+
+	size_t size() const {
+		return count;
+	}
+
+	void clear() {
+		count = 0;
+	}
+
+	void reserve(size_t new_capacity);
+	void push_back(const rectangle<T>& rect);
+
+	// out, xs and ys must hold size() values.
+	void areas(double* out) const;
+	void centers(double* xs, double* ys) const;
+	size_t count_area_less_than(double square) const;
+
+private:
+	static constexpr size_t kColumns = 8;
+	static constexpr size_t kPadding = 4;
+
+	// Column of coordinate c (0..3 are x of vertices 0..3, 4..7 their y).
+	double* column(size_t c) const {
+		return data + c * capacity;
+	}
+
+	template<class Pack>
+	Pack area_at(size_t i) const;
+
+	template<class Pack>
+	void areas_range(double* out, size_t first, size_t last) const;
+
+	template<class Pack>
+	void centers_range(double* xs, double* ys, size_t first, size_t last) const;
+
+	template<class Pack>
+	size_t count_range(double square, size_t first, size_t last) const;
+
+	size_t simd_end() const {
+		return count - count % SimdPack::width;
+	}
+
+	double* data = nullptr;
+	size_t count = 0;
+	size_t capacity = 0;
+};
+
+template<class T>
+void RectangleSet<T>::reserve(size_t new_capacity) {
+	if (new_capacity <= capacity) {
+		return;
+	}
+	new_capacity = (new_capacity + kPadding - 1) / kPadding * kPadding;
+	double* new_data = static_cast<double*>(std::aligned_alloc(32, kColumns * new_capacity * sizeof(double)));
+	if (new_data == nullptr) {
+		throw std::bad_alloc();
+	}
+	for (size_t c = 0; c < kColumns; ++c) {
+		if (count != 0) {
+			std::memcpy(new_data + c * new_capacity, column(c), count * sizeof(double));
+		}
+		std::fill(new_data + c * new_capacity + count, new_data + (c + 1) * new_capacity, 0.0);
+	}
+	std::free(data);
+	data = new_data;
+	capacity = new_capacity;
+}
+
+template<class T>
+void RectangleSet<T>::push_back(const rectangle<T>& rect) {
+	if (count == capacity) {
+		reserve(std::max<size_t>(2 * capacity, kPadding));
+	}
+	for (size_t v = 0; v < 4; ++v) {
+		column(v)[count] = double(rect.vertices[v].x);
+		column(4 + v)[count] = double(rect.vertices[v].y);
+	}
+	++count;
+}
+
+// Same operations in the same order as rectangle::area, so the result is identical.
+template<class T>
+template<class Pack>
+Pack RectangleSet<T>::area_at(size_t i) const {
+	Pack x0 = Pack::load(column(0) + i), x1 = Pack::load(column(1) + i), x2 = Pack::load(column(2) + i);
+	Pack y0 = Pack::load(column(4) + i), y1 = Pack::load(column(5) + i), y2 = Pack::load(column(6) + i);
+	Pack ax = x1 - x0, ay = y1 - y0;
+	Pack bx = x2 - x1, by = y2 - y1;
+	return sqrt(ax * ax + ay * ay) * sqrt(bx * bx + by * by);
+}
+
+template<class T>
+template<class Pack>
+void RectangleSet<T>::areas_range(double* out, size_t first, size_t last) const {
+	for (size_t i = first; i < last; i += Pack::width) {
+		area_at<Pack>(i).store(out + i);
+	}
+}
+
+template<class T>
+template<class Pack>
+void RectangleSet<T>::centers_range(double* xs, double* ys, size_t first, size_t last) const {
+	Pack quarter = Pack::broadcast(0.25);
+	for (size_t i = first; i < last; i += Pack::width) {
+		Pack x = (Pack::load(column(0) + i) + Pack::load(column(1) + i) + Pack::load(column(2) + i) + Pack::load(column(3) + i)) * quarter;
+		Pack y = (Pack::load(column(4) + i) + Pack::load(column(5) + i) + Pack::load(column(6) + i) + Pack::load(column(7) + i)) * quarter;
+		// rectangle::center divides in T, which truncates for integers.
+		if constexpr (std::is_integral<T>::value) {
+			x = trunc(x);
+			y = trunc(y);
+		}
+		x.store(xs + i);
+		y.store(ys + i);
+	}
+}
+
+template<class T>
+template<class Pack>
+size_t RectangleSet<T>::count_range(double square, size_t first, size_t last) const {
+	Pack limit = Pack::broadcast(square);
+	size_t res = 0;
+	for (size_t i = first; i < last; i += Pack::width) {
+		res += count_less(area_at<Pack>(i), limit);
+	}
+	return res;
+}
+
+template<class T>
+void RectangleSet<T>::areas(double* out) const {
+	areas_range<SimdPack>(out, 0, simd_end());
+	areas_range<ScalarPack>(out, simd_end(), count);
+}
+
+template<class T>
+void RectangleSet<T>::centers(double* xs, double* ys) const {
+	centers_range<SimdPack>(xs, ys, 0, simd_end());
+	centers_range<ScalarPack>(xs, ys, simd_end(), count);
+}
+
+template<class T>
+size_t RectangleSet<T>::count_area_less_than(double square) const {
+	return count_range<SimdPack>(square, 0, simd_end()) + count_range<ScalarPack>(square, simd_end(), count);
+}
+
+#endif // D_RECTANGLE_SET_H_
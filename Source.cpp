@@ -10,6 +10,10 @@
 #include "Allocator.h"
 #include "Vector.h"
 #include "Allocator.h"
+#include "ParallelQueries.h"
+#include "SpatialGrid.h"
+#include "AreaIndex.h"
+#include "RectangleLoader.h"
 #include <map>
 
 void menu() {
@@ -20,6 +24,13 @@ void menu() {
 	std::cout << "4 : GO THROUGH VECTOR WITH ITERATOR AND SHOW EVERY STEP\n";
 	std::cout << "5 : CHANGE OBJECT BY INDEX\n";
 	std::cout << "6 : RESIZE VECTOR\n";
+	std::cout << "7 : SHOW AREA STATISTICS AND CENTROID\n";
+	std::cout << "8 : FIND OBJECTS CONTAINING POINT\n";
+	std::cout << "9 : FIND OBJECTS INTERSECTING REGION\n";
+	std::cout << "10 : FIND OBJECTS WITH NEAREST CENTERS\n";
+	std::cout << "11 : GET AMOUNT OF OBJECTS WITH SQUARE IN RANGE\n";
+	std::cout << "12 : GET INDEX OF OBJECT WITH K-TH SMALLEST SQUARE\n";
+	std::cout << "13 : LOAD VECTOR FROM FILE\n";
 	std::cout << "> ";
 }
 
@@ -42,6 +53,17 @@ int main() {
 	Containers::Vector< rectangle< int >, Allocators::Allocator< rectangle< int >, 1000 > > vec;
 	vec.Resize(size);
 
+	Parallel::ThreadPool pool;
+	Containers::SpatialGrid<int> grid;
+	Containers::AreaIndex<int> area_index;
+	Containers::RectangleLoader<int> loader(&pool);
+
+	auto print_indices = [](const std::vector<size_t>& indices) {
+		std::cout << "Indices :";
+		for (size_t index : indices) std::cout << ' ' << index;
+		std::cout << '\n';
+	};
+
 	while(true) {
 
 		menu();
@@ -56,8 +78,10 @@ int main() {
 				std::cout << "Enter vertices : \n";
 				rectangle<int> rect(std::cin);
 				vec[i] = rect;
+				area_index.Update(i, rect);
 
 			}
+			grid.Build(vec.begin(), vec.end());
 
 		} else if (cmd == 2) {
 
@@ -74,16 +98,19 @@ int main() {
 			std::cin >> square;
 
 			int cmdcmd;
-			std::cout << "Do you want to use std::count_if? : 1 - yes; 0 - no; : ";
+			std::cout << "Do you want to use std::count_if? : 1 - yes; 2 - yes, in parallel; 3 - no, use area index; 0 - no; : ";
 			std::cin >> cmdcmd;
 
-			if (cmdcmd == 1) res = std::count_if(vec.begin(), vec.end(), [&square](rectangle<int>& i) {return i.area() < square;});
+			// Unfilled elements are not objects; the area index does not hold them either.
+			if (cmdcmd == 3) res = area_index.CountBelow(square);
+			else if (cmdcmd == 2) res = Parallel::CountIf(pool, vec.begin(), vec.end(), [&square](const rectangle<int>& i) {return i.existance && i.area_less_than(square);});
+			else if (cmdcmd == 1) res = std::count_if(vec.begin(), vec.end(), [&square](rectangle<int>& i) {return i.existance && i.area_less_than(square);});
 			else {
 				auto it = vec.begin();
 				auto end = vec.end();
 
 				while (it != end) {
-					if ((*it).area() < square) res++;
+					if ((*it).existance && (*it).area_less_than(square)) res++;
 					++it;
 				}
 			}
@@ -127,6 +154,8 @@ int main() {
 				std::cout << "Enter vertices : \n";
 				rectangle<int> rect(std::cin);
 				vec[index] = rect;
+				grid.Update(index, rect);
+				area_index.Update(index, rect);
 
 			}
 
@@ -142,9 +171,101 @@ int main() {
 			} else {
 
 				vec.Resize(size);
+				grid.Truncate(size);
+				area_index.Truncate(size);
+
+			}
+
+		} else if (cmd == 7) {
+
+			Parallel::AreaSummary areas = Parallel::Areas(pool, vec.begin(), vec.end());
+
+			if (areas.count == 0) {
+
+				std::cout << "Vector has no filled objects.\n";
+
+			} else {
+
+				std::cout << "Statistics of " << areas.count << " filled objects\n";
+				std::cout << "Total area is " << areas.sum << '\n';
+				std::cout << "Min area is " << areas.min << '\n';
+				std::cout << "Max area is " << areas.max << '\n';
+				std::cout << "Centroid is " << Parallel::Centroid(pool, vec.begin(), vec.end());
 
 			}
 
+		} else if (cmd == 8) {
+
+			vertex<double> point;
+			std::cout << "Enter point : ";
+			std::cin >> point;
+			print_indices(grid.Containing(point));
+
+		} else if (cmd == 9) {
+
+			Containers::BoundingBox region;
+			std::cout << "Enter lower left and upper right corners : ";
+			std::cin >> region.min >> region.max;
+			print_indices(grid.Intersecting(region));
+
+		} else if (cmd == 10) {
+
+			vertex<double> point;
+			size_t amount;
+			std::cout << "Enter point and amount : ";
+			std::cin >> point >> amount;
+			print_indices(grid.Nearest(point, amount));
+
+		} else if (cmd == 11) {
+
+			double low, high;
+			std::cout << "Enter lower and upper squares : ";
+			std::cin >> low >> high;
+			std::cout << "Amount is " << area_index.CountInRange(low, high) << '\n';
+
+		} else if (cmd == 12) {
+
+			size_t k;
+			std::cout << "Enter k : ";
+			std::cin >> k;
+
+			if (k >= area_index.Size()) {
+
+				std::cout << "Out of range.\n";
+
+			} else {
+
+				std::cout << "Index is " << area_index.KthSmallest(k) << '\n';
+
+			}
+
+		} else if (cmd == 13) {
+
+			std::string path;
+			std::cout << "Enter file name : ";
+			std::cin >> path;
+
+			// The file replaces the vector only once all of it has been read, so a
+			// failed load keeps the current objects.
+			decltype(vec) loaded;
+
+			try {
+
+				loader.Load(path, loaded);
+
+			} catch (const std::exception& e) {
+
+				std::cout << e.what() << '\n';
+				continue;
+
+			}
+
+			vec.Resize(0);
+			vec.Append(loaded.begin(), loaded.end());
+			grid.Build(vec.begin(), vec.end());
+			area_index.Build(vec.begin(), vec.end());
+			std::cout << "Loaded " << vec.Size() << " objects\n";
+
 		}
 	
 	}
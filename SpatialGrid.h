@@ -0,0 +1,392 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <stdexcept>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "rectangle.h"
+
+namespace Containers {
+
+    struct BoundingBox {
+        vertex<double> min;
+        vertex<double> max;
+
+        bool Contains(vertex<double> point) const {
+            return min.x <= point.x && point.x <= max.x && min.y <= point.y && point.y <= max.y;
+        }
+
+        bool Intersects(const BoundingBox &other) const {
+            return min.x <= other.max.x && other.min.x <= max.x && min.y <= other.max.y && other.min.y <= max.y;
+        }
+    };
+
+    // Hierarchical grid over rectangles identified by their index in a container.
+    // Level L has cells of cell_size * 2^L, and every rectangle is listed in each
+    // cell its bounding box covers on the lowest level where that is at most four
+    // cells, so no rectangle costs more than four cells whatever its size. Queries
+    // visit every level that holds rectangles. Centers are kept in one cell of a
+    // separate level-0 grid used by the nearest-neighbour search. Replacing or
+    // removing a rectangle touches only its own cells. Queries are exact for rotated
+    // rectangles too, and boundaries count as inside.
+    template<typename T>
+    class SpatialGrid {
+    public:
+        // cell_size is used until Build picks one from the data.
+        explicit SpatialGrid(double cell_size = 8) : cell_size_(cell_size) {
+            if (!(cell_size > 0)) {
+                throw std::logic_error("Cell size must be positive");
+            }
+        }
+
+        // Indexes the rectangles of [first, last) under their positions, with the
+        // median bounding box side of the rectangles as the cell size.
+        template<typename ForwardIt>
+        void Build(ForwardIt first, ForwardIt last) {
+            entries_.clear();
+            levels_.clear();
+            centers_.clear();
+            count_ = 0;
+            std::vector<double> sides;
+            for (ForwardIt it = first; it != last; ++it) {
+                if (it->existance) {
+                    BoundingBox box = BoxOf(*it);
+                    sides.push_back(std::max(box.max.x - box.min.x, box.max.y - box.min.y));
+                }
+            }
+            if (!sides.empty()) {
+                std::nth_element(sides.begin(), sides.begin() + sides.size() / 2, sides.end());
+                if (sides[sides.size() / 2] > 0) {
+                    cell_size_ = sides[sides.size() / 2];
+                }
+            }
+            for (size_t id = 0; first != last; ++first, ++id) {
+                Update(id, *first);
+            }
+        }
+
+        // Puts rect under id, replacing what was there. Rectangles that do not exist
+        // (default-constructed ones) are only removed.
+        void Update(size_t id, const rectangle<T> &rect) {
+            Erase(id);
+            if (!rect.existance) {
+                return;
+            }
+            if (id >= entries_.size()) {
+                entries_.resize(id + 1);
+            }
+            Entry &entry = entries_[id];
+            vertex<double> origin = {double(rect.vertices[0].x), double(rect.vertices[0].y)};
+            entry.origin = origin;
+            entry.sides[0] = {double(rect.vertices[1].x) - origin.x, double(rect.vertices[1].y) - origin.y};
+            entry.sides[1] = {double(rect.vertices[3].x) - origin.x, double(rect.vertices[3].y) - origin.y};
+            entry.box = BoxOf(rect);
+            entry.center = rect.center();
+            entry.indexed = true;
+            entry.level = 0;
+            while (CellsCount(entry.box, entry.level) > kMaxCellsPerRectangle) {
+                ++entry.level;
+            }
+            if (entry.level >= levels_.size()) {
+                levels_.resize(entry.level + 1);
+            }
+            ForEachCell(entry.box, entry.level, [&](int64_t x, int64_t y) {
+                levels_[entry.level][Key(x, y)].push_back(id);
+            });
+            Cell center = CellOf(entry.center);
+            centers_[Key(center.first, center.second)].push_back(id);
+            if (count_++ == 0) {
+                center_bounds_ = {center, center};
+            } else {
+                center_bounds_.first = {std::min(center_bounds_.first.first, center.first),
+                                        std::min(center_bounds_.first.second, center.second)};
+                center_bounds_.second = {std::max(center_bounds_.second.first, center.first),
+                                         std::max(center_bounds_.second.second, center.second)};
+            }
+        }
+
+        void Erase(size_t id) {
+            if (id >= entries_.size() || !entries_[id].indexed) {
+                return;
+            }
+            Entry &entry = entries_[id];
+            ForEachCell(entry.box, entry.level, [&](int64_t x, int64_t y) {
+                RemoveFrom(levels_[entry.level], Key(x, y), id);
+            });
+            Cell center = CellOf(entry.center);
+            RemoveFrom(centers_, Key(center.first, center.second), id);
+            entry.indexed = false;
+            --count_;
+        }
+
+        // Forgets ids from size on, after the indexed container shrank.
+        void Truncate(size_t size) {
+            for (size_t id = size; id < entries_.size(); ++id) {
+                Erase(id);
+            }
+            entries_.resize(std::min(size, entries_.size()));
+        }
+
+        size_t Size() const {
+            return count_;
+        }
+
+        // Ids of the rectangles containing point, in increasing order.
+        std::vector<size_t> Containing(vertex<double> point) const {
+            std::vector<size_t> result;
+            auto visit = [&](const std::vector<size_t> &ids) {
+                for (size_t id : ids) {
+                    const Entry &entry = entries_[id];
+                    if (entry.box.Contains(point) && InsideRectangle(entry, point)) {
+                        result.push_back(id);
+                    }
+                }
+            };
+            for (size_t level = 0; level < levels_.size(); ++level) {
+                Cell cell = CellOf(point, level);
+                auto it = levels_[level].find(Key(cell.first, cell.second));
+                if (it != levels_[level].end()) {
+                    visit(it->second);
+                }
+            }
+            std::sort(result.begin(), result.end());
+            return result;
+        }
+
+        // Ids of the rectangles that intersect region, in increasing order.
+        std::vector<size_t> Intersecting(const BoundingBox &region) const {
+            std::vector<size_t> result;
+            auto visit = [&](size_t level, int64_t x, int64_t y, const std::vector<size_t> &ids) {
+                for (size_t id : ids) {
+                    const Entry &entry = entries_[id];
+                    if (!entry.box.Intersects(region)) {
+                        continue;
+                    }
+                    // A rectangle spans several cells; it is reported from the cell
+                    // holding the lower corner of its overlap with the region.
+                    Cell first = CellOf({std::max(entry.box.min.x, region.min.x), std::max(entry.box.min.y, region.min.y)}, level);
+                    if (first.first == x && first.second == y && Overlaps(entry, region)) {
+                        result.push_back(id);
+                    }
+                }
+            };
+            for (size_t level = 0; level < levels_.size(); ++level) {
+                const CellMap &cells = levels_[level];
+                Cell low = CellOf(region.min, level);
+                Cell high = CellOf(region.max, level);
+                if (CellsCount(region, level) > double(cells.size())) {
+                    for (const auto &cell : cells) {
+                        int64_t x = UnpackX(cell.first), y = UnpackY(cell.first);
+                        if (low.first <= x && x <= high.first && low.second <= y && y <= high.second) {
+                            visit(level, x, y, cell.second);
+                        }
+                    }
+                } else {
+                    ForEachCell(region, level, [&](int64_t x, int64_t y) {
+                        auto it = cells.find(Key(x, y));
+                        if (it != cells.end()) {
+                            visit(level, x, y, it->second);
+                        }
+                    });
+                }
+            }
+            std::sort(result.begin(), result.end());
+            return result;
+        }
+
+        // Ids of the k rectangles whose centers are nearest to point, nearest first;
+        // ties go to the smaller id. Searches rings of cells around the point, and
+        // scans everything once the rings get larger than the occupied grid.
+        std::vector<size_t> Nearest(vertex<double> point, size_t k) const {
+            std::vector<std::pair<double, size_t>> best;
+            if (k == 0 || count_ == 0) {
+                return {};
+            }
+            auto consider = [&](size_t id) {
+                const vertex<double> &center = entries_[id].center;
+                double dx = center.x - point.x, dy = center.y - point.y;
+                std::pair<double, size_t> candidate(dx * dx + dy * dy, id);
+                if (best.size() < k) {
+                    best.push_back(candidate);
+                    std::push_heap(best.begin(), best.end());
+                } else if (candidate < best.front()) {
+                    std::pop_heap(best.begin(), best.end());
+                    best.back() = candidate;
+                    std::push_heap(best.begin(), best.end());
+                }
+            };
+            Cell origin = CellOf(point);
+            int64_t last_ring = std::max({origin.first - center_bounds_.first.first,
+                                          center_bounds_.second.first - origin.first,
+                                          origin.second - center_bounds_.first.second,
+                                          center_bounds_.second.second - origin.second});
+            bool scan_all = false;
+            for (int64_t ring = 0; ring <= last_ring; ++ring) {
+                double reach = double(ring - 1) * cell_size_;
+                if (best.size() == k && ring > 0 && reach * reach > best.front().first) {
+                    break;
+                }
+                if (double(2 * ring + 1) * double(2 * ring + 1) > 4.0 * double(centers_.size())) {
+                    scan_all = true;
+                    break;
+                }
+                ForEachRingCell(origin, ring, [&](int64_t x, int64_t y) {
+                    auto it = centers_.find(Key(x, y));
+                    if (it != centers_.end()) {
+                        for (size_t id : it->second) {
+                            consider(id);
+                        }
+                    }
+                });
+            }
+            if (scan_all) {
+                best.clear();
+                for (size_t id = 0; id < entries_.size(); ++id) {
+                    if (entries_[id].indexed) {
+                        consider(id);
+                    }
+                }
+            }
+            std::sort_heap(best.begin(), best.end());
+            std::vector<size_t> result;
+            for (const auto &item : best) {
+                result.push_back(item.second);
+            }
+            return result;
+        }
+
+    private:
+        using Cell = std::pair<int64_t, int64_t>;
+        using CellMap = std::unordered_map<uint64_t, std::vector<size_t>>;
+
+        struct Entry {
+            bool indexed = false;
+            size_t level = 0;
+            BoundingBox box;
+            vertex<double> center;
+            vertex<double> origin;
+            vertex<double> sides[2];
+        };
+
+        static constexpr double kMaxCell = 1 << 30;
+        static constexpr double kMaxCellsPerRectangle = 4;
+
+        static BoundingBox BoxOf(const rectangle<T> &rect) {
+            vertex<double> first = {double(rect.vertices[0].x), double(rect.vertices[0].y)};
+            BoundingBox box = {first, first};
+            for (const vertex<T> &corner : rect.vertices) {
+                box.min = {std::min(box.min.x, double(corner.x)), std::min(box.min.y, double(corner.y))};
+                box.max = {std::max(box.max.x, double(corner.x)), std::max(box.max.y, double(corner.y))};
+            }
+            return box;
+        }
+
+        double CellsCount(const BoundingBox &box, size_t level) const {
+            Cell low = CellOf(box.min, level);
+            Cell high = CellOf(box.max, level);
+            return double(high.first - low.first + 1) * double(high.second - low.second + 1);
+        }
+
+        Cell CellOf(vertex<double> point, size_t level = 0) const {
+            double size = std::ldexp(cell_size_, int(level));
+            auto coordinate = [size](double value) {
+                return int64_t(std::max(-kMaxCell, std::min(kMaxCell, std::floor(value / size))));
+            };
+            return {coordinate(point.x), coordinate(point.y)};
+        }
+
+        static uint64_t Key(int64_t x, int64_t y) {
+            return (uint64_t(uint32_t(x)) << 32) | uint32_t(y);
+        }
+
+        static int64_t UnpackX(uint64_t key) {
+            return int32_t(uint32_t(key >> 32));
+        }
+
+        static int64_t UnpackY(uint64_t key) {
+            return int32_t(uint32_t(key));
+        }
+
+        template<typename Function>
+        void ForEachCell(const BoundingBox &box, size_t level, Function function) const {
+            Cell low = CellOf(box.min, level);
+            Cell high = CellOf(box.max, level);
+            for (int64_t x = low.first; x <= high.first; ++x) {
+                for (int64_t y = low.second; y <= high.second; ++y) {
+                    function(x, y);
+                }
+            }
+        }
+
+        template<typename Function>
+        static void ForEachRingCell(Cell origin, int64_t ring, Function function) {
+            if (ring == 0) {
+                function(origin.first, origin.second);
+                return;
+            }
+            for (int64_t x = origin.first - ring; x <= origin.first + ring; ++x) {
+                function(x, origin.second - ring);
+                function(x, origin.second + ring);
+            }
+            for (int64_t y = origin.second - ring + 1; y < origin.second + ring; ++y) {
+                function(origin.first - ring, y);
+                function(origin.first + ring, y);
+            }
+        }
+
+        static void RemoveFrom(CellMap &map, uint64_t key, size_t id) {
+            auto it = map.find(key);
+            std::vector<size_t> &ids = it->second;
+            *std::find(ids.begin(), ids.end(), id) = ids.back();
+            ids.pop_back();
+            if (ids.empty()) {
+                map.erase(it);
+            }
+        }
+
+        static double Dot(vertex<double> a, vertex<double> b) {
+            return a.x * b.x + a.y * b.y;
+        }
+
+        static bool InsideRectangle(const Entry &entry, vertex<double> point) {
+            vertex<double> offset = {point.x - entry.origin.x, point.y - entry.origin.y};
+            for (const vertex<double> &side : entry.sides) {
+                double along = Dot(offset, side);
+                if (along < 0 || along > Dot(side, side)) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        // Separating axis test between the rectangle and an axis-aligned region whose
+        // bounding boxes are already known to overlap: only the sides of the
+        // rectangle remain to be tried as axes.
+        static bool Overlaps(const Entry &entry, const BoundingBox &region) {
+            vertex<double> corners[4] = {region.min, {region.min.x, region.max.y}, region.max, {region.max.x, region.min.y}};
+            for (const vertex<double> &side : entry.sides) {
+                double low = Dot(corners[0], side), high = low;
+                for (const vertex<double> &corner : corners) {
+                    low = std::min(low, Dot(corner, side));
+                    high = std::max(high, Dot(corner, side));
+                }
+                double start = Dot(entry.origin, side);
+                if (high < start || low > start + Dot(side, side)) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        double cell_size_;
+        std::vector<Entry> entries_;
+        std::vector<CellMap> levels_;
+        CellMap centers_;
+        std::pair<Cell, Cell> center_bounds_;
+        size_t count_ = 0;
+    };
+
+}
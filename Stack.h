@@ -2,14 +2,24 @@
 
 #include <memory>
 #include <exception>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
 
 namespace Containers {
 
+    // Links are plain pointers: the list owns its nodes and frees them itself.
+    struct StackNodeBase {
+        StackNodeBase* next = nullptr;
+        StackNodeBase* prev = nullptr;
+    };
+
     template <typename T>
-    struct StackNode {
+    struct StackNode : StackNodeBase {
+        template <typename... Args>
+        explicit StackNode(std::in_place_t, Args&&... args) : data(std::forward<Args>(args)...) {}
+
         T data;
-        std::shared_ptr<StackNode> next;
-        std::weak_ptr<StackNode> prev;
     };
 
     template <typename T>
@@ -20,31 +30,22 @@ namespace Containers {
         using difference_type = ptrdiff_t;
         using iterator_category = std::forward_iterator_tag;
 
-        StackIterator(std::shared_ptr<StackNode<T>> ptr)
+        StackIterator(StackNodeBase* ptr)
         : ptr_(ptr){}
 
-        T& operator * () {
-            std::shared_ptr<StackNode<T>> locked = ptr_.lock();
-            if (!locked) {
-                throw std::runtime_error("Iterator does not exist");
-            }
-            return locked->data;
+        T& operator * () const {
+            return static_cast<StackNode<T>*>(ptr_)->data;
         }
 
-        T* operator -> () {
-            std::shared_ptr<StackNode<T>> locked = ptr_.lock();
-            if (!locked) {
-                throw std::runtime_error("Iterator does not exist");
-            }
-            return &locked->data;
+        T* operator -> () const {
+            return &static_cast<StackNode<T>*>(ptr_)->data;
         }
 
         StackIterator& operator++() {
-            std::shared_ptr<StackNode<T>> locked = ptr_.lock();
-            if (!locked || locked->next == nullptr) {
+            if (ptr_->next == nullptr) {
                 throw std::runtime_error("Out of bounds");
             }
-            ptr_ = locked->next;
+            ptr_ = ptr_->next;
             return *this;
         }
 
@@ -55,14 +56,14 @@ namespace Containers {
         }
 
         bool operator == (const StackIterator& other) const {
-            return ptr_.lock() == other.ptr_.lock();
+            return ptr_ == other.ptr_;
         }
 
         bool operator != (const StackIterator& other) const {
             return !(*this == other);
         }
 
-        std::weak_ptr<StackNode<T>> ptr_;
+        StackNodeBase* ptr_;
     };
 
     template <typename T, typename Allocator = std::allocator<T>>
@@ -70,63 +71,49 @@ namespace Containers {
     public:
         using allocator_type = typename Allocator::template rebind<StackNode<T>>::other;
 
-        struct deleter {
-            deleter(allocator_type* allocator) : allocator_(allocator) {}
+        Stack() = default;
 
-            void operator() (StackNode<T>* ptr) {
-                std::allocator_traits<allocator_type >::destroy(*allocator_, ptr);
-                allocator_->deallocate(ptr,1);
-            }
-
-        private:
-            allocator_type* allocator_;
-        };
-
-        Stack() {
-            StackNode<T>* ptr = allocator_.allocate(1);
-            std::allocator_traits<allocator_type >::construct(allocator_, ptr);
-            std::shared_ptr<StackNode<T>> new_elem(ptr, deleter(&allocator_));
-            tail = new_elem;
-            head = tail;
-            tail->next = nullptr;
-        }
+        explicit Stack(const Allocator &allocator) : allocator_(allocator) {}
 
         Stack(const Stack&) = delete;
         Stack(Stack&&) = delete;
 
+        ~Stack() {
+            StackNodeBase* node = head;
+            while (node != &tail) {
+                StackNodeBase* next = node->next;
+                DeleteNode(node);
+                node = next;
+            }
+        }
+
         bool Empty() const {
-            return head == tail;
+            return head == &tail;
         }
 
         void Pop() {
             if (Empty()){
                 throw std::runtime_error("Pop from empty queue");
             }
-            if (head->next == tail) {
-                head = tail;
-                return;
-            }
-            std::shared_ptr<StackNode<T>> prev_ptr = tail->prev.lock()->prev.lock();
-            prev_ptr->next = tail;
-            tail->prev = prev_ptr;
+            Unlink(tail.prev);
         }
 
         void Push(T elem) {
-            StackNode<T>* ptr = allocator_.allocate(1);
-            std::allocator_traits<allocator_type>::construct(allocator_, ptr);
-            std::shared_ptr<StackNode<T>> new_elem(ptr, deleter(&allocator_));
-            new_elem->data = std::move(elem);
-            if (Empty()) {
-                head = new_elem;
-                tail->prev = head;
-                head->next = tail;
-                return;
+            EmplaceBack(std::move(elem));
+        }
+
+        template <typename... Args>
+        T& EmplaceBack(Args&&... args) {
+            StackNode<T>* node = NewNode(std::forward<Args>(args)...);
+            Link(&tail, node);
+            return node->data;
+        }
+
+        template <typename InputIt>
+        void Append(InputIt first, InputIt last) {
+            for (; first != last; ++first) {
+                Link(&tail, NewNode(*first));
             }
-            std::shared_ptr<StackNode<T>> prev_ptr = tail->prev.lock();
-            prev_ptr->next = new_elem;
-            tail->prev = new_elem;
-            new_elem->next = tail;
-            new_elem->prev = prev_ptr;
         }
 
         StackIterator<T> begin() {
@@ -134,48 +121,79 @@ namespace Containers {
         }
 
         StackIterator<T> end() {
-            return StackIterator<T>(tail);
+            return StackIterator<T>(&tail);
         }
 
         void Insert(StackIterator<T> iter, T elem) {
-            StackNode<T>* ptr = allocator_.allocate(1);
-            std::allocator_traits<allocator_type>::construct(allocator_, ptr);
-            std::shared_ptr<StackNode<T>> new_elem(ptr, deleter(&allocator_));
-            new_elem->data = std::move(elem);
-            if (iter == begin()) {
-                new_elem->next = head;
-                head->prev = new_elem;
-                head = new_elem;
-            } else {
-                std::shared_ptr<StackNode<T>> cur_ptr = iter.ptr_.lock();
-                std::shared_ptr<StackNode<T>> prev_ptr = iter.ptr_.lock()->prev.lock();
-                prev_ptr->next = new_elem;
-                cur_ptr->prev = new_elem;
-                new_elem->next = cur_ptr;
-                new_elem->prev = prev_ptr;
+            Emplace(iter, std::move(elem));
+        }
+
+        template <typename InputIt, typename = std::enable_if_t<!std::is_integral<InputIt>::value>>
+        void Insert(StackIterator<T> iter, InputIt first, InputIt last) {
+            for (; first != last; ++first) {
+                Link(iter.ptr_, NewNode(*first));
             }
         }
 
+        // Constructs the element right before iter; returns an iterator to it.
+        template <typename... Args>
+        StackIterator<T> Emplace(StackIterator<T> iter, Args&&... args) {
+            StackNode<T>* node = NewNode(std::forward<Args>(args)...);
+            Link(iter.ptr_, node);
+            return StackIterator<T>(node);
+        }
+
         void Erase(StackIterator<T> iter) {
             if (iter == end()) {
                 throw std::runtime_error("Erasind end iterator");
             }
-            std::shared_ptr<StackNode<T>> ptr = iter.ptr_.lock();
-            if (iter == begin()) {
-                head = head->next;
-                ptr->next = nullptr;
+            Unlink(iter.ptr_);
+        }
+
+    private:
+        template <typename... Args>
+        StackNode<T>* NewNode(Args&&... args) {
+            StackNode<T>* ptr = allocator_.allocate(1);
+            try {
+                std::allocator_traits<allocator_type>::construct(allocator_, ptr, std::in_place, std::forward<Args>(args)...);
+            } catch (...) {
+                allocator_.deallocate(ptr, 1);
+                throw;
+            }
+            return ptr;
+        }
+
+        void DeleteNode(StackNodeBase* node) {
+            StackNode<T>* ptr = static_cast<StackNode<T>*>(node);
+            std::allocator_traits<allocator_type>::destroy(allocator_, ptr);
+            allocator_.deallocate(ptr, 1);
+        }
+
+        // Puts node right before pos.
+        void Link(StackNodeBase* pos, StackNodeBase* node) {
+            node->next = pos;
+            node->prev = pos->prev;
+            if (pos->prev != nullptr) {
+                pos->prev->next = node;
             } else {
-                std::shared_ptr<StackNode<T>> prev_ptr = ptr->prev.lock();
-                std::shared_ptr<StackNode<T>> next_ptr = ptr->next;
-                prev_ptr->next = next_ptr;
-                next_ptr->prev = prev_ptr;
+                head = node;
             }
+            pos->prev = node;
+        }
+
+        void Unlink(StackNodeBase* node) {
+            if (node->prev != nullptr) {
+                node->prev->next = node->next;
+            } else {
+                head = node->next;
+            }
+            node->next->prev = node->prev;
+            DeleteNode(node);
         }
 
-    private:
         allocator_type allocator_;
-        std::shared_ptr<StackNode<T>> head;
-        std::shared_ptr<StackNode<T>> tail;
+        StackNodeBase tail;
+        StackNodeBase* head = &tail;
     };
 
 }
\ No newline at end of file
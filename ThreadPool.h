@@ -0,0 +1,128 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Parallel {
+
+    // Fixed set of worker threads that run one parallel loop at a time. The index
+    // range of a loop is cut into chunks which the workers and the calling thread
+    // take from a shared counter, so a thread that finishes early takes more of
+    // them. Loops from several threads are run one after another; a loop body must
+    // not start a loop on the same pool.
+    class ThreadPool {
+    public:
+        explicit ThreadPool(size_t threads_count = std::thread::hardware_concurrency()) {
+            for (size_t i = 1; i < std::max<size_t>(threads_count, 1); ++i) {
+                workers_.emplace_back([this] { WorkerLoop(); });
+            }
+        }
+
+        ThreadPool(const ThreadPool &) = delete;
+
+        ThreadPool(ThreadPool &&) = delete;
+
+        ~ThreadPool() {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                stopping_ = true;
+            }
+            wake_.notify_all();
+            for (std::thread &worker : workers_) {
+                worker.join();
+            }
+        }
+
+        // Threads that run a loop, the caller included.
+        size_t Size() const {
+            return workers_.size() + 1;
+        }
+
+        // Calls body(begin, end) for consecutive chunks of [0, count), at most grain
+        // indices each, and returns when all of them are done. The first exception
+        // thrown by body is rethrown here once the other chunks have finished.
+        void ParallelFor(size_t count, size_t grain, const std::function<void(size_t, size_t)> &body) {
+            if (count == 0) {
+                return;
+            }
+            grain = std::max<size_t>(grain, 1);
+            std::lock_guard<std::mutex> loop_lock(loop_mutex_);
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                body_ = &body;
+                count_ = count;
+                grain_ = grain;
+                next_chunk_.store(0, std::memory_order_relaxed);
+                error_ = nullptr;
+                busy_workers_ = workers_.size();
+                ++generation_;
+            }
+            wake_.notify_all();
+            RunChunks();
+            std::unique_lock<std::mutex> lock(mutex_);
+            done_.wait(lock, [this] { return busy_workers_ == 0; });
+            body_ = nullptr;
+            if (error_ != nullptr) {
+                std::rethrow_exception(error_);
+            }
+        }
+
+    private:
+        void WorkerLoop() {
+            size_t seen_generation = 0;
+            while (true) {
+                {
+                    std::unique_lock<std::mutex> lock(mutex_);
+                    wake_.wait(lock, [&] { return stopping_ || generation_ != seen_generation; });
+                    if (stopping_) {
+                        return;
+                    }
+                    seen_generation = generation_;
+                }
+                RunChunks();
+                std::lock_guard<std::mutex> lock(mutex_);
+                if (--busy_workers_ == 0) {
+                    done_.notify_one();
+                }
+            }
+        }
+
+        void RunChunks() {
+            while (true) {
+                size_t begin = next_chunk_.fetch_add(1, std::memory_order_relaxed) * grain_;
+                if (begin >= count_) {
+                    return;
+                }
+                try {
+                    (*body_)(begin, std::min(count_, begin + grain_));
+                } catch (...) {
+                    std::lock_guard<std::mutex> lock(mutex_);
+                    if (error_ == nullptr) {
+                        error_ = std::current_exception();
+                    }
+                }
+            }
+        }
+
+        std::vector<std::thread> workers_;
+        std::mutex loop_mutex_;
+        std::mutex mutex_;
+        std::condition_variable wake_;
+        std::condition_variable done_;
+        bool stopping_ = false;
+        size_t generation_ = 0;
+        size_t busy_workers_ = 0;
+        const std::function<void(size_t, size_t)> *body_ = nullptr;
+        size_t count_ = 0;
+        size_t grain_ = 1;
+        std::atomic<size_t> next_chunk_{0};
+        std::exception_ptr error_;
+    };
+
+}
@@ -0,0 +1,238 @@
+#pragma once
+
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include "Stack.h"
+
+namespace Containers {
+
+    // Node of an unrolled list: up to CHUNK_SIZE elements stored contiguously.
+    template <typename T, size_t CHUNK_SIZE>
+    struct UnrolledChunk : StackNodeBase {
+        size_t count = 0;
+        alignas(T) unsigned char storage[CHUNK_SIZE * sizeof(T)];
+
+        T* Data() {
+            return reinterpret_cast<T*>(storage);
+        }
+
+        bool Full() const {
+            return count == CHUNK_SIZE;
+        }
+    };
+
+    template <typename T, size_t CHUNK_SIZE>
+    struct UnrolledStackIterator {
+        using value_type = T;
+        using reference = T&;
+        using pointer = T*;
+        using difference_type = ptrdiff_t;
+        using iterator_category = std::forward_iterator_tag;
+        using Chunk = UnrolledChunk<T, CHUNK_SIZE>;
+
+        UnrolledStackIterator(StackNodeBase* chunk, size_t index)
+        : chunk_(chunk), index_(index) {}
+
+        T& operator * () const {
+            return static_cast<Chunk*>(chunk_)->Data()[index_];
+        }
+
+        T* operator -> () const {
+            return static_cast<Chunk*>(chunk_)->Data() + index_;
+        }
+
+        UnrolledStackIterator& operator++() {
+            if (chunk_->next == nullptr) {
+                throw std::runtime_error("Out of bounds");
+            }
+            if (++index_ == static_cast<Chunk*>(chunk_)->count) {
+                chunk_ = chunk_->next;
+                index_ = 0;
+            }
+            return *this;
+        }
+
+        const UnrolledStackIterator operator++(int) {
+            auto copy = *this;
+            ++(*this);
+            return copy;
+        }
+
+        bool operator == (const UnrolledStackIterator& other) const {
+            return chunk_ == other.chunk_ && index_ == other.index_;
+        }
+
+        bool operator != (const UnrolledStackIterator& other) const {
+            return !(*this == other);
+        }
+
+        StackNodeBase* chunk_;
+        size_t index_;
+    };
+
+    // Same interface as Stack, but elements are kept CHUNK_SIZE to a node, so there
+    // is one allocation per chunk and traversal walks contiguous memory. A full chunk
+    // is split in halves on Insert; on Erase a chunk is merged with the next one when
+    // both fit into one. Insert and Erase invalidate iterators into the touched chunks.
+    template <typename T, typename Allocator = std::allocator<T>, size_t CHUNK_SIZE = 16>
+    class UnrolledStack {
+    public:
+        static_assert(CHUNK_SIZE > 0, "Chunk must hold at least one element");
+
+        using Chunk = UnrolledChunk<T, CHUNK_SIZE>;
+        using iterator = UnrolledStackIterator<T, CHUNK_SIZE>;
+        using allocator_type = typename Allocator::template rebind<Chunk>::other;
+
+        UnrolledStack() = default;
+
+        explicit UnrolledStack(const Allocator &allocator) : allocator_(allocator) {}
+
+        UnrolledStack(const UnrolledStack&) = delete;
+        UnrolledStack(UnrolledStack&&) = delete;
+
+        ~UnrolledStack() {
+            StackNodeBase* node = head;
+            while (node != &tail) {
+                StackNodeBase* next = node->next;
+                Chunk* chunk = static_cast<Chunk*>(node);
+                for (size_t i = 0; i < chunk->count; ++i) {
+                    chunk->Data()[i].~T();
+                }
+                DeleteChunk(chunk);
+                node = next;
+            }
+        }
+
+        bool Empty() const {
+            return head == &tail;
+        }
+
+        void Pop() {
+            if (Empty()){
+                throw std::runtime_error("Pop from empty queue");
+            }
+            Chunk* last = static_cast<Chunk*>(tail.prev);
+            last->Data()[--last->count].~T();
+            if (last->count == 0) {
+                Unlink(last);
+            }
+        }
+
+        void Push(T elem) {
+            Chunk* last = static_cast<Chunk*>(tail.prev);
+            if (last == nullptr || last->Full()) {
+                last = NewChunk(&tail);
+            }
+            new (last->Data() + last->count) T(std::move(elem));
+            ++last->count;
+        }
+
+        iterator begin() {
+            return iterator(head, 0);
+        }
+
+        iterator end() {
+            return iterator(&tail, 0);
+        }
+
+        void Insert(iterator iter, T elem) {
+            if (iter == end()) {
+                Push(std::move(elem));
+                return;
+            }
+            Chunk* chunk = static_cast<Chunk*>(iter.chunk_);
+            size_t index = iter.index_;
+            if (chunk->Full()) {
+                Chunk* upper = NewChunk(chunk->next);
+                size_t half = CHUNK_SIZE / 2;
+                for (size_t i = half; i < CHUNK_SIZE; ++i) {
+                    new (upper->Data() + upper->count) T(std::move(chunk->Data()[i]));
+                    ++upper->count;
+                    chunk->Data()[i].~T();
+                }
+                chunk->count = half;
+                if (index > half) {
+                    chunk = upper;
+                    index -= half;
+                }
+            }
+            T* data = chunk->Data();
+            if (index == chunk->count) {
+                new (data + index) T(std::move(elem));
+            } else {
+                new (data + chunk->count) T(std::move(data[chunk->count - 1]));
+                for (size_t i = chunk->count - 1; i > index; --i) {
+                    data[i] = std::move(data[i - 1]);
+                }
+                data[index] = std::move(elem);
+            }
+            ++chunk->count;
+        }
+
+        void Erase(iterator iter) {
+            if (iter == end()) {
+                throw std::runtime_error("Erasind end iterator");
+            }
+            Chunk* chunk = static_cast<Chunk*>(iter.chunk_);
+            T* data = chunk->Data();
+            for (size_t i = iter.index_; i + 1 < chunk->count; ++i) {
+                data[i] = std::move(data[i + 1]);
+            }
+            data[--chunk->count].~T();
+            if (chunk->count == 0) {
+                Unlink(chunk);
+                return;
+            }
+            if (chunk->next != &tail) {
+                Chunk* next = static_cast<Chunk*>(chunk->next);
+                if (chunk->count + next->count <= CHUNK_SIZE) {
+                    for (size_t i = 0; i < next->count; ++i) {
+                        new (data + chunk->count) T(std::move(next->Data()[i]));
+                        ++chunk->count;
+                        next->Data()[i].~T();
+                    }
+                    next->count = 0;
+                    Unlink(next);
+                }
+            }
+        }
+
+    private:
+        // Creates an empty chunk right before pos.
+        Chunk* NewChunk(StackNodeBase* pos) {
+            Chunk* chunk = allocator_.allocate(1);
+            new (chunk) Chunk();
+            chunk->next = pos;
+            chunk->prev = pos->prev;
+            if (pos->prev != nullptr) {
+                pos->prev->next = chunk;
+            } else {
+                head = chunk;
+            }
+            pos->prev = chunk;
+            return chunk;
+        }
+
+        void DeleteChunk(Chunk* chunk) {
+            chunk->~Chunk();
+            allocator_.deallocate(chunk, 1);
+        }
+
+        // Removes an already emptied chunk from the list and frees it.
+        void Unlink(Chunk* chunk) {
+            if (chunk->prev != nullptr) {
+                chunk->prev->next = chunk->next;
+            } else {
+                head = chunk->next;
+            }
+            chunk->next->prev = chunk->prev;
+            DeleteChunk(chunk);
+        }
+
+        allocator_type allocator_;
+        StackNodeBase tail;
+        StackNodeBase* head = &tail;
+    };
+
+}
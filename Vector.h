@@ -1,44 +1,81 @@
 #pragma once
 
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <iterator>
 #include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
 
 namespace Containers {
 
-    template <typename T, typename Allocator>
-    class Vector;
-    template<typename T, typename Allocator>
+    // Allocators that can resize a block in place offer try_expand(ptr, new_size).
+    template<typename Allocator, typename T, typename = void>
+    struct HasTryExpand : std::false_type {};
+
+    template<typename Allocator, typename T>
+    struct HasTryExpand<Allocator, T, std::void_t<decltype(
+            std::declval<Allocator &>().try_expand(std::declval<T *>(), size_t()))>> : std::true_type {};
+
+    // Vector iterators are bounds checked unless NDEBUG is defined; define
+    // CONTAINERS_CHECKED_ITERATORS to 0 or 1 to choose explicitly.
+#ifndef CONTAINERS_CHECKED_ITERATORS
+#ifdef NDEBUG
+#define CONTAINERS_CHECKED_ITERATORS 0
+#else
+#define CONTAINERS_CHECKED_ITERATORS 1
+#endif
+#endif
+
+    template<typename T>
     class VectorIterator;
+    template<typename T, typename Container>
+    class CheckedVectorIterator;
 
-    template <typename T, typename Allocator = std::allocator<T>>
-    class Vector {
-    public:
+    // Raw space for N elements kept inside the vector object.
+    template<typename T, size_t N>
+    struct InlineStorage {
+        alignas(T) unsigned char storage[N * sizeof(T)];
 
-        friend VectorIterator<T, Allocator>;
+        T* Data() {
+            return reinterpret_cast<T*>(storage);
+        }
+    };
 
-        struct deleter {
-            deleter(Allocator* allocator, size_t size) : allocator_(allocator), size_(size) {}
-            void operator() (T* ptr) {
-                if (ptr != nullptr) {
-                    allocator_->deallocate(ptr, size_);
-                }
-            }
-        private:
-            Allocator* allocator_;
-            size_t size_;
-        };
+    template<typename T>
+    struct InlineStorage<T, 0> {
+        T* Data() {
+            return nullptr;
+        }
+    };
+
+    // With INLINE_CAPACITY > 0 the first elements live in the object itself and the
+    // allocator is only asked for memory once the vector outgrows them.
+    template <typename T, typename Allocator = std::allocator<T>, size_t INLINE_CAPACITY = 0>
+    class Vector {
+    public:
+        using value_type = T;
+        using iterator = std::conditional_t<CONTAINERS_CHECKED_ITERATORS,
+                CheckedVectorIterator<T, Vector>, VectorIterator<T>>;
+        using const_iterator = std::conditional_t<CONTAINERS_CHECKED_ITERATORS,
+                CheckedVectorIterator<const T, const Vector>, VectorIterator<const T>>;
 
         Vector() = default;
 
-        Vector(size_t size) : size_(size) {
-            T* ptr = allocator_.allocate(size);
-            data_ = std::shared_ptr<T>(ptr, deleter(&allocator_, size));
+        explicit Vector(const Allocator &allocator) : allocator_(allocator) {}
+
+        Vector(size_t size) {
+            Resize(size);
         }
 
 
         ~Vector() {
             for (size_t i = 0; i < size_; ++i) {
-                std::allocator_traits<Allocator>::destroy(allocator_, (data_.get()) + i);
+                std::allocator_traits<Allocator>::destroy(allocator_, elements_ + i);
             }
+            FreeStorage(data_, capacity_);
         }
 
         Vector(const Vector &) = delete;
@@ -49,68 +86,139 @@ namespace Containers {
             if (index >= size_) {
                 throw std::out_of_range("Out of bounds");
             }
-            return data_.get()[index];
+            return elements_[index];
         }
 
         const T &operator[](size_t index) const {
             if (index >= size_) {
                 throw std::out_of_range("Out of bounds");
             }
-            return data_.get()[index];
+            return elements_[index];
         }
 
+        // New elements are value-initialized. Shrinking keeps the capacity.
         void Resize(size_t new_size) {
-            /*if (new_size == 0) {
-                data_ = nullptr;
-                return;
-            }*/
             if (new_size < size_) {
                 for (size_t i = new_size; i < size_; ++i) {
-                    std::allocator_traits<Allocator>::destroy(allocator_,data_.get() + i);
+                    std::allocator_traits<Allocator>::destroy(allocator_,elements_ + i);
                 }
+                size_ = new_size;
+                return;
             }
-            T* ptr = allocator_.allocate(new_size);
-            std::shared_ptr<T> new_data = std::shared_ptr<T>(ptr, deleter(&allocator_, new_size));
-            for (size_t i = 0; i < std::min(new_size, size_); ++i) {
-                new_data.get()[i] = data_.get()[i];
-                std::allocator_traits<Allocator>::destroy(allocator_,data_.get() + i);
+            Grow(new_size);
+            for (; size_ < new_size; ++size_) {
+                std::allocator_traits<Allocator>::construct(allocator_, elements_ + size_);
             }
-            data_ = new_data;
-            size_ = new_size;
         }
 
+        void Reserve(size_t new_capacity) {
+            if (new_capacity > capacity_) {
+                Reallocate(new_capacity);
+            }
+        }
 
-        VectorIterator<T, Allocator> begin() {
-            return VectorIterator<T, Allocator>(this, 0);
+        // Moves the elements back inline when they fit there.
+        void ShrinkToFit() {
+            if (capacity_ == size_ || data_ == nullptr) {
+                return;
+            }
+            if (size_ <= INLINE_CAPACITY) {
+                MoveElementsTo(nullptr, INLINE_CAPACITY);
+                return;
+            }
+            Reallocate(size_);
         }
 
-        VectorIterator<T, Allocator> end() {
-            return VectorIterator<T, Allocator>(this, size_);
+        void PushBack(T elem) {
+            EmplaceBack(std::move(elem));
         }
 
-        void Insert(VectorIterator<T, Allocator> it, T elem) {
-            if (it.container_ != this) {
-                throw std::runtime_error("Wrong iterator");
+        void PopBack() {
+            if (size_ == 0) {
+                throw std::runtime_error("Pop from empty vector");
             }
-            size_t position = it.pos_;
-            Resize(size_ + 1);
-            for (size_t i = size_ - 1; i > position; --i) {
-                data_.get()[i] = data_.get()[i - 1];
+            std::allocator_traits<Allocator>::destroy(allocator_, elements_ + --size_);
+        }
+
+        iterator begin() {
+            return MakeIterator<iterator>(this, 0);
+        }
+
+        iterator end() {
+            return MakeIterator<iterator>(this, size_);
+        }
+
+        const_iterator begin() const {
+            return MakeIterator<const_iterator>(this, 0);
+        }
+
+        const_iterator end() const {
+            return MakeIterator<const_iterator>(this, size_);
+        }
+
+        // The new element is built before the old ones move, so args may refer to them.
+        template <typename... Args>
+        T& EmplaceBack(Args&&... args) {
+            if (size_ < capacity_ || TryResizeInPlace(NextCapacity(size_ + 1))) {
+                std::allocator_traits<Allocator>::construct(allocator_, elements_ + size_, std::forward<Args>(args)...);
+            } else {
+                size_t new_capacity = NextCapacity(size_ + 1);
+                T* new_data = allocator_.allocate(new_capacity);
+                try {
+                    std::allocator_traits<Allocator>::construct(allocator_, new_data + size_, std::forward<Args>(args)...);
+                } catch (...) {
+                    FreeStorage(new_data, new_capacity);
+                    throw;
+                }
+                try {
+                    MoveElementsTo(new_data, new_capacity);
+                } catch (...) {
+                    std::allocator_traits<Allocator>::destroy(allocator_, new_data + size_);
+                    FreeStorage(new_data, new_capacity);
+                    throw;
+                }
             }
-            data_.get()[position] = elem;
+            return elements_[size_++];
         }
 
-        void Erase(VectorIterator<T, Allocator> it) {
-            if (it.container_ != this) {
-                throw std::runtime_error("Wrong iterator");
+        // Constructs the element at the end and rotates it into place.
+        template <typename... Args>
+        T& Emplace(iterator it, Args&&... args) {
+            size_t position = CheckedPosition(it);
+            EmplaceBack(std::forward<Args>(args)...);
+            std::rotate(elements_ + position, elements_ + size_ - 1, elements_ + size_);
+            return elements_[position];
+        }
+
+        void Insert(iterator it, T elem) {
+            Emplace(it, std::move(elem));
+        }
+
+        // Needs forward iterators: the storage is grown once for the whole range.
+        template <typename ForwardIt, typename = std::enable_if_t<!std::is_integral<ForwardIt>::value>>
+        void Insert(iterator it, ForwardIt first, ForwardIt last) {
+            size_t position = CheckedPosition(it);
+            size_t old_size = size_;
+            Append(first, last);
+            std::rotate(elements_ + position, elements_ + old_size, elements_ + size_);
+        }
+
+        template <typename ForwardIt>
+        void Append(ForwardIt first, ForwardIt last) {
+            Grow(size_ + std::distance(first, last));
+            for (; first != last; ++first) {
+                std::allocator_traits<Allocator>::construct(allocator_, elements_ + size_, *first);
+                ++size_;
             }
-            T* temp = data_.get();
-            size_t position = it.pos_;
-            for (size_t i = position; i < size_ - 1; ++i) {
-                data_.get()[i] = data_.get()[i + 1];
+        }
+
+        void Erase(iterator it) {
+            size_t position = CheckedPosition(it);
+            if (position == size_) {
+                throw std::out_of_range("Out of bounds");
             }
-            data_.get()[size_ - 1] = *temp;
-            Resize(size_ - 1);
+            std::move(elements_ + position + 1, elements_ + size_, elements_ + position);
+            PopBack();
         }
 
 
@@ -118,59 +226,358 @@ namespace Containers {
             return size_;
         }
 
+        size_t Capacity() const {
+            return capacity_;
+        }
+
     private:
+        template<typename Iterator, typename Self>
+        static Iterator MakeIterator(Self *self, size_t pos) {
+            if constexpr (CONTAINERS_CHECKED_ITERATORS) {
+                return Iterator(self, pos);
+            } else {
+                return Iterator(self->elements_ + pos);
+            }
+        }
+
+        size_t CheckedPosition(const iterator &it) const {
+            if constexpr (CONTAINERS_CHECKED_ITERATORS) {
+                if (it.container() != this || it.index() > size_) {
+                    throw std::runtime_error("Wrong iterator");
+                }
+                return it.index();
+            } else {
+                std::less<const T *> less;
+                if (less(it.base(), elements_) || less(elements_ + size_, it.base())) {
+                    throw std::runtime_error("Wrong iterator");
+                }
+                return it.base() - elements_;
+            }
+        }
+
+        // Capacity doubles, so a sequence of appends costs amortized O(1) moves each.
+        size_t NextCapacity(size_t required) const {
+            return std::max(required, 2 * capacity_);
+        }
+
+        void Grow(size_t required) {
+            if (required > capacity_) {
+                Reallocate(NextCapacity(required));
+            }
+        }
+
+        // Moves the elements into storage for new_capacity elements, in place if the
+        // allocator can resize the block.
+        void Reallocate(size_t new_capacity) {
+            if (TryResizeInPlace(new_capacity)) {
+                return;
+            }
+            T* new_data = allocator_.allocate(new_capacity);
+            try {
+                MoveElementsTo(new_data, new_capacity);
+            } catch (...) {
+                FreeStorage(new_data, new_capacity);
+                throw;
+            }
+        }
+
+        void FreeStorage(T* storage, size_t storage_size) {
+            if (storage != nullptr) {
+                allocator_.deallocate(storage, storage_size);
+            }
+        }
+
+        // Trivially copyable elements are relocated with one memcpy. Others are move
+        // constructed, or copied when the move may throw, so a failure in the middle
+        // leaves the old storage untouched and new_data for the caller to free. Null
+        // new_data means the inline storage.
+        void MoveElementsTo(T* new_data, size_t new_capacity) {
+            T* target = new_data != nullptr ? new_data : inline_.Data();
+            if constexpr (std::is_trivially_copyable<T>::value) {
+                if (size_ != 0) {
+                    std::memcpy(static_cast<void*>(target), elements_, size_ * sizeof(T));
+                }
+            } else {
+                size_t constructed = 0;
+                try {
+                    for (; constructed < size_; ++constructed) {
+                        std::allocator_traits<Allocator>::construct(allocator_, target + constructed,
+                                                                    std::move_if_noexcept(elements_[constructed]));
+                    }
+                } catch (...) {
+                    for (size_t i = 0; i < constructed; ++i) {
+                        std::allocator_traits<Allocator>::destroy(allocator_, target + i);
+                    }
+                    throw;
+                }
+                for (size_t i = 0; i < size_; ++i) {
+                    std::allocator_traits<Allocator>::destroy(allocator_, elements_ + i);
+                }
+            }
+            FreeStorage(data_, capacity_);
+            data_ = new_data;
+            elements_ = target;
+            capacity_ = new_capacity;
+        }
+
+        bool TryResizeInPlace(size_t new_size) {
+            if constexpr (HasTryExpand<Allocator, T>::value) {
+                if (data_ == nullptr || !allocator_.try_expand(elements_, new_size)) {
+                    return false;
+                }
+                capacity_ = new_size;
+                return true;
+            } else {
+                return false;
+            }
+        }
+
         Allocator allocator_;
-        std::shared_ptr<T> data_ = nullptr;
+        // Allocated storage of capacity_ elements, null while the elements are inline.
+        T* data_ = nullptr;
+        InlineStorage<T, INLINE_CAPACITY> inline_;
+        T* elements_ = inline_.Data();
         size_t size_ = 0;
+        size_t capacity_ = INLINE_CAPACITY;
     };
 
 
-    template<typename T, typename Allocator>
+    // Release iterator: a plain pointer into the storage.
+    template<typename T>
     class VectorIterator {
     public:
+        using value_type = std::remove_const_t<T>;
+        using reference = T &;
+        using pointer = T *;
+        using difference_type = ptrdiff_t;
+        using iterator_category = std::random_access_iterator_tag;
 
-        friend Vector<T, Allocator>;
+        VectorIterator() = default;
 
-        using value_type = T;
+        explicit VectorIterator(T *ptr) : ptr_(ptr) {}
+
+        // A mutable iterator converts to a const one.
+        template<typename U, typename = std::enable_if_t<std::is_same<const U, T>::value>>
+        VectorIterator(const VectorIterator<U> &other) : ptr_(other.base()) {}
+
+        T *base() const {
+            return ptr_;
+        }
+
+        T &operator*() const {
+            return *ptr_;
+        }
+
+        T *operator->() const {
+            return ptr_;
+        }
+
+        T &operator[](difference_type n) const {
+            return ptr_[n];
+        }
+
+        VectorIterator &operator++() {
+            ++ptr_;
+            return *this;
+        }
+
+        VectorIterator operator++(int) {
+            VectorIterator result = *this;
+            ++ptr_;
+            return result;
+        }
+
+        VectorIterator &operator--() {
+            --ptr_;
+            return *this;
+        }
+
+        VectorIterator operator--(int) {
+            VectorIterator result = *this;
+            --ptr_;
+            return result;
+        }
+
+        VectorIterator &operator+=(difference_type n) {
+            ptr_ += n;
+            return *this;
+        }
+
+        VectorIterator &operator-=(difference_type n) {
+            ptr_ -= n;
+            return *this;
+        }
+
+        friend VectorIterator operator+(VectorIterator it, difference_type n) {
+            return it += n;
+        }
+
+        friend VectorIterator operator+(difference_type n, VectorIterator it) {
+            return it += n;
+        }
+
+        friend VectorIterator operator-(VectorIterator it, difference_type n) {
+            return it -= n;
+        }
+
+        friend difference_type operator-(const VectorIterator &lhs, const VectorIterator &rhs) {
+            return lhs.ptr_ - rhs.ptr_;
+        }
+
+        friend bool operator==(const VectorIterator &lhs, const VectorIterator &rhs) {
+            return lhs.ptr_ == rhs.ptr_;
+        }
+
+        friend bool operator!=(const VectorIterator &lhs, const VectorIterator &rhs) {
+            return lhs.ptr_ != rhs.ptr_;
+        }
+
+        friend bool operator<(const VectorIterator &lhs, const VectorIterator &rhs) {
+            return lhs.ptr_ < rhs.ptr_;
+        }
+
+        friend bool operator>(const VectorIterator &lhs, const VectorIterator &rhs) {
+            return lhs.ptr_ > rhs.ptr_;
+        }
+
+        friend bool operator<=(const VectorIterator &lhs, const VectorIterator &rhs) {
+            return lhs.ptr_ <= rhs.ptr_;
+        }
+
+        friend bool operator>=(const VectorIterator &lhs, const VectorIterator &rhs) {
+            return lhs.ptr_ >= rhs.ptr_;
+        }
+
+    private:
+        T *ptr_ = nullptr;
+    };
+
+    // Debug iterator: remembers its container and position, so dereferencing or
+    // stepping outside [begin, end] and mixing iterators of two vectors throw.
+    // Container is const for a const_iterator.
+    template<typename T, typename Container>
+    class CheckedVectorIterator {
+    public:
+        using value_type = std::remove_const_t<T>;
         using reference = T &;
         using pointer = T *;
         using difference_type = ptrdiff_t;
-        using iterator_category = std::forward_iterator_tag;
+        using iterator_category = std::random_access_iterator_tag;
 
+        CheckedVectorIterator() = default;
 
-        VectorIterator(Vector<T, Allocator> *cont, size_t pos)
+        CheckedVectorIterator(Container *cont, size_t pos)
                 : container_(cont), pos_(pos) {}
 
-        T &operator*() {
+        template<typename U, typename OtherContainer, typename = std::enable_if_t<
+                std::is_same<const U, T>::value && std::is_same<const OtherContainer, Container>::value>>
+        CheckedVectorIterator(const CheckedVectorIterator<U, OtherContainer> &other)
+                : container_(other.container()), pos_(other.index()) {}
+
+        Container *container() const {
+            return container_;
+        }
+
+        size_t index() const {
+            return pos_;
+        }
+
+        T &operator*() const {
             return (*container_)[pos_];
         }
 
-        bool operator==(const VectorIterator &other) {
-            return container_ == other.container_ && pos_ == other.pos_;
+        T *operator->() const {
+            return &(*container_)[pos_];
         }
 
-        bool operator!=(const VectorIterator &other) {
-            return !(*this == other);
+        T &operator[](difference_type n) const {
+            return (*container_)[pos_ + n];
         }
 
-        VectorIterator &operator++() {
-            if (pos_ + 1 > container_->size_) {
+        CheckedVectorIterator &operator++() {
+            return *this += 1;
+        }
+
+        CheckedVectorIterator operator++(int) {
+            CheckedVectorIterator result = *this;
+            *this += 1;
+            return result;
+        }
+
+        CheckedVectorIterator &operator--() {
+            return *this -= 1;
+        }
+
+        CheckedVectorIterator operator--(int) {
+            CheckedVectorIterator result = *this;
+            *this -= 1;
+            return result;
+        }
+
+        // A position past the end is left from before the vector shrank.
+        CheckedVectorIterator &operator+=(difference_type n) {
+            if (container_ == nullptr || pos_ > container_->Size() || (n < 0 && size_t(-n) > pos_) ||
+                (n > 0 && size_t(n) > container_->Size() - pos_)) {
                 throw std::runtime_error("Out of bounds");
-            } else {
-                pos_++;
             }
+            pos_ += n;
             return *this;
-        };
+        }
 
-        VectorIterator operator++(int) {
-            VectorIterator result = *this;
-            ++(*this);
-            return result;
+        CheckedVectorIterator &operator-=(difference_type n) {
+            return *this += -n;
+        }
+
+        friend CheckedVectorIterator operator+(CheckedVectorIterator it, difference_type n) {
+            return it += n;
+        }
+
+        friend CheckedVectorIterator operator+(difference_type n, CheckedVectorIterator it) {
+            return it += n;
+        }
+
+        friend CheckedVectorIterator operator-(CheckedVectorIterator it, difference_type n) {
+            return it -= n;
+        }
+
+        friend difference_type operator-(const CheckedVectorIterator &lhs, const CheckedVectorIterator &rhs) {
+            lhs.CheckSameContainer(rhs);
+            return difference_type(lhs.pos_) - difference_type(rhs.pos_);
+        }
+
+        friend bool operator==(const CheckedVectorIterator &lhs, const CheckedVectorIterator &rhs) {
+            return lhs.container_ == rhs.container_ && lhs.pos_ == rhs.pos_;
+        }
+
+        friend bool operator!=(const CheckedVectorIterator &lhs, const CheckedVectorIterator &rhs) {
+            return !(lhs == rhs);
+        }
+
+        friend bool operator<(const CheckedVectorIterator &lhs, const CheckedVectorIterator &rhs) {
+            return lhs - rhs < 0;
+        }
+
+        friend bool operator>(const CheckedVectorIterator &lhs, const CheckedVectorIterator &rhs) {
+            return rhs < lhs;
+        }
+
+        friend bool operator<=(const CheckedVectorIterator &lhs, const CheckedVectorIterator &rhs) {
+            return !(rhs < lhs);
+        }
+
+        friend bool operator>=(const CheckedVectorIterator &lhs, const CheckedVectorIterator &rhs) {
+            return !(lhs < rhs);
         }
 
     private:
-        Vector<T, Allocator> *container_;
-        size_t pos_;
+        void CheckSameContainer(const CheckedVectorIterator &other) const {
+            if (container_ != other.container_) {
+                throw std::runtime_error("Wrong iterator");
+            }
+        }
+
+        Container *container_ = nullptr;
+        size_t pos_ = 0;
     };
 
 }
\ No newline at end of file
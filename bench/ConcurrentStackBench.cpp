@@ -0,0 +1,98 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "ConcurrentAllocator.h"
+#include "ConcurrentStack.h"
+#include "Stack.h"
+
+// Contention benchmark: every thread pushes its share of the values, popping one
+// after each push, then drains what is left. Thread counts double from 1 to the
+// number given on the command line (hardware concurrency by default).
+//
+//     ConcurrentStackBench [max_threads] [operations]
+
+namespace {
+
+    // A Stack behind one mutex. Stack has no accessor for its last element, so
+    // values are taken from the front; the order does not matter here.
+    class LockedStack {
+    public:
+        void Push(int value) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stack_.Push(value);
+        }
+
+        bool TryPop(int &out) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (stack_.Empty()) {
+                return false;
+            }
+            auto it = stack_.begin();
+            out = *it;
+            stack_.Erase(it);
+            return true;
+        }
+
+    private:
+        std::mutex mutex_;
+        Containers::Stack<int> stack_;
+    };
+
+    // Returns the run time in milliseconds; exits if a value got lost or duplicated.
+    template<typename Stack>
+    double Run(size_t threads_count, size_t operations) {
+        Stack stack;
+        size_t per_thread = operations / threads_count;
+        std::atomic<long long> sum{0};
+        auto start = std::chrono::steady_clock::now();
+        std::vector<std::thread> threads;
+        for (size_t t = 0; t < threads_count; ++t) {
+            threads.emplace_back([&, t] {
+                long long local = 0;
+                int value;
+                for (size_t i = 0; i < per_thread; ++i) {
+                    stack.Push(int(t * per_thread + i));
+                    if (stack.TryPop(value)) {
+                        local += value;
+                    }
+                }
+                while (stack.TryPop(value)) {
+                    local += value;
+                }
+                sum += local;
+            });
+        }
+        for (std::thread &thread : threads) {
+            thread.join();
+        }
+        double elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        long long total = (long long)(threads_count * per_thread);
+        if (sum != total * (total - 1) / 2) {
+            std::fprintf(stderr, "values lost with %zu threads\n", threads_count);
+            std::exit(1);
+        }
+        return elapsed;
+    }
+
+}
+
+int main(int argc, char **argv) {
+    size_t max_threads = argc > 1 ? std::stoul(argv[1]) : std::max(1u, std::thread::hardware_concurrency());
+    size_t operations = argc > 2 ? std::stoul(argv[2]) : 1000000;
+    using LockFree = Containers::ConcurrentStack<int>;
+    using LockFreePooled = Containers::ConcurrentStack<int, Allocators::ConcurrentAllocator<int, 1 << 20>>;
+    std::printf("%8s %16s %26s %16s\n", "threads", "lock-free ms", "lock-free + Concurrent ms", "mutex Stack ms");
+    for (size_t threads = 1; threads <= max_threads; threads *= 2) {
+        std::printf("%8zu %16.1f %26.1f %16.1f\n", threads,
+                    Run<LockFree>(threads, operations),
+                    Run<LockFreePooled>(threads, operations),
+                    Run<LockedStack>(threads, operations));
+    }
+    return 0;
+}
@@ -0,0 +1,95 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <thread>
+#include "ParallelQueries.h"
+#include "Vector.h"
+#include "rectangle.h"
+
+// Scaling benchmark of the parallel bulk queries: CountIf on area, Areas and
+// Centroid over a vector of random rectangles, first as plain serial loops, then
+// on thread pools doubling from 1 to the number given on the command line
+// (hardware concurrency by default).
+//
+//     ParallelQueriesBench [max_threads] [rectangles]
+
+namespace {
+
+    constexpr int kRounds = 5;
+
+    template<typename Function>
+    double MillisecondsPerRound(Function function) {
+        auto start = std::chrono::steady_clock::now();
+        for (int round = 0; round < kRounds; ++round) {
+            function();
+        }
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / kRounds;
+    }
+
+    bool SmallArea(const rectangle<int> &rect) {
+        return rect.area() < 100;
+    }
+
+}
+
+int main(int argc, char **argv) {
+    size_t max_threads = argc > 1 ? std::stoul(argv[1]) : std::max(1u, std::thread::hardware_concurrency());
+    size_t count = argc > 2 ? std::stoul(argv[2]) : 2000000;
+
+    std::mt19937 rng(1);
+    std::uniform_int_distribution<int> position(-10000, 10000), side(1, 20);
+    Containers::Vector<rectangle<int>> rects;
+    rects.Reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        int x = position(rng), y = position(rng), w = side(rng), h = side(rng);
+        vertex<int> quad[4] = {{x, y}, {x, y + h}, {x + w, y + h}, {x + w, y}};
+        rects.PushBack(rectangle<int>(quad));
+    }
+
+    size_t expected = 0;
+    double serial_count = MillisecondsPerRound([&] {
+        expected = std::count_if(rects.begin(), rects.end(), SmallArea);
+    });
+    Parallel::AreaSummary summary;
+    double serial_areas = MillisecondsPerRound([&] {
+        summary = Parallel::AreaSummary();
+        for (const rectangle<int> &rect : rects) {
+            summary.Add(rect.area());
+        }
+    });
+    vertex<double> sum{0, 0};
+    double serial_centroid = MillisecondsPerRound([&] {
+        sum = {0, 0};
+        for (const rectangle<int> &rect : rects) {
+            sum = sum + rect.center();
+        }
+    });
+
+    std::printf("%zu rectangles, area sum %.0f, centroid (%.3f, %.3f), ms per query\n",
+                count, summary.sum, sum.x / double(count), sum.y / double(count));
+    std::printf("%8s %10s %10s %10s\n", "threads", "CountIf", "Areas", "Centroid");
+    std::printf("%8s %10.2f %10.2f %10.2f\n", "serial", serial_count, serial_areas, serial_centroid);
+    for (size_t threads = 1; threads <= max_threads; threads *= 2) {
+        Parallel::ThreadPool pool(threads);
+        size_t counted = 0;
+        Parallel::AreaSummary areas;
+        double count_ms = MillisecondsPerRound([&] {
+            counted = Parallel::CountIf(pool, rects.begin(), rects.end(), SmallArea);
+        });
+        double areas_ms = MillisecondsPerRound([&] {
+            areas = Parallel::Areas(pool, rects.begin(), rects.end());
+        });
+        double centroid_ms = MillisecondsPerRound([&] {
+            Parallel::Centroid(pool, rects.begin(), rects.end());
+        });
+        if (counted != expected || areas.count != summary.count || areas.max != summary.max) {
+            std::fprintf(stderr, "parallel results differ from the serial ones\n");
+            return 1;
+        }
+        std::printf("%8zu %10.2f %10.2f %10.2f\n", threads, count_ms, areas_ms, centroid_ms);
+    }
+    return 0;
+}
@@ -0,0 +1,82 @@
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <map>
+#include <memory>
+#include <random>
+#include <string>
+#include "Allocator.h"
+#include "PoolAllocator.h"
+
+// Insert/erase churn on std::map under each allocator: every operation draws a key
+// and erases it when present, inserts it otherwise, so the map hovers around half
+// of the key range and nodes are freed and reused in random order.
+//
+//     PoolAllocatorBench [operations] [keys]
+
+namespace {
+
+    constexpr size_t kArenaBytes = size_t(1) << 22;
+    constexpr size_t kPoolSlots = size_t(1) << 16;
+
+    template<typename Alloc>
+    using Map = std::map<int, int, std::less<>, Alloc>;
+
+    // Returns the run time in milliseconds and the sum of the keys left in the map,
+    // which must be the same for every allocator.
+    template<typename Alloc>
+    double Run(size_t operations, int keys, long long &checksum) {
+        std::mt19937 rng(1);
+        auto map = std::make_unique<Map<Alloc>>();
+        auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < operations; ++i) {
+            int key = int(rng() % unsigned(keys));
+            auto it = map->find(key);
+            if (it != map->end()) {
+                map->erase(it);
+            } else {
+                map->emplace(key, key);
+            }
+        }
+        double elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        checksum = 0;
+        for (const auto &item : *map) {
+            checksum += item.first;
+        }
+        return elapsed;
+    }
+
+    template<typename Alloc>
+    void Report(const char *name, size_t operations, int keys, long long &expected) {
+        long long checksum;
+        double elapsed = Run<Alloc>(operations, keys, checksum);
+        if (expected < 0) {
+            expected = checksum;
+        } else if (checksum != expected) {
+            std::fprintf(stderr, "%s left different keys in the map\n", name);
+            std::exit(1);
+        }
+        std::printf("%-24s %10.1f\n", name, elapsed);
+    }
+
+}
+
+int main(int argc, char **argv) {
+    size_t operations = argc > 1 ? std::stoul(argv[1]) : 1000000;
+    int keys = argc > 2 ? std::stoi(argv[2]) : 16384;
+    if (keys <= 0 || size_t(keys) > kPoolSlots) {
+        std::fprintf(stderr, "keys must be in 1..%zu\n", kPoolSlots);
+        return 1;
+    }
+    using Node = std::pair<const int, int>;
+    long long expected = -1;
+    std::printf("%-24s %10s\n", "allocator", "ms");
+    Report<std::allocator<Node>>("std::allocator", operations, keys, expected);
+    Report<Allocators::Allocator<Node, kArenaBytes, Allocators::FirstFit>>("Allocator FirstFit", operations, keys,
+                                                                           expected);
+    Report<Allocators::Allocator<Node, kArenaBytes, Allocators::SegregatedFit>>("Allocator SegregatedFit", operations,
+                                                                                keys, expected);
+    Report<Allocators::PoolAllocator<Node, kPoolSlots>>("PoolAllocator", operations, keys, expected);
+    return 0;
+}
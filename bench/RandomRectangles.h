@@ -0,0 +1,53 @@
+#pragma once
+
+#include <random>
+#include <type_traits>
+#include "rectangle.h"
+
+// Random rotated rectangles for the benchmarks. The first side (a, b) has integer
+// components within side_radius, the second one is k = 1..3 times the first turned
+// by 90 degrees, and the first corner lies within world_radius of the origin, so
+// every corner is an integer point. Draws again when both components are zero.
+class RandomRectangles {
+public:
+    explicit RandomRectangles(unsigned seed = 1) : rng_(seed) {}
+
+    // Uniform in [-radius, radius].
+    int Random(int radius) {
+        return int(rng_() % (2 * unsigned(radius) + 1)) - radius;
+    }
+
+    // Corners in the order they go around the rectangle.
+    void Corners(int world_radius, int side_radius, vertex<int> (&quad)[4]) {
+        int x = Random(world_radius), y = Random(world_radius), a = 0, b = 0;
+        while (a == 0 && b == 0) {
+            a = Random(side_radius);
+            b = Random(side_radius);
+        }
+        int k = 1 + int(rng_() % 3);
+        quad[0] = {x, y};
+        quad[1] = {x + a, y + b};
+        quad[2] = {x + a - k * b, y + b + k * a};
+        quad[3] = {x - k * b, y + k * a};
+    }
+
+    // Corners are moved by shift, so that floating point ones need not be integers.
+    template<class T>
+    rectangle<T> Next(int world_radius, int side_radius, T shift = T(0)) {
+        vertex<int> corners[4];
+        Corners(world_radius, side_radius, corners);
+        vertex<T> quad[4];
+        for (int i = 0; i < 4; ++i) {
+            quad[i] = {T(corners[i].x) + shift, T(corners[i].y) + shift};
+        }
+        validate_rectangle(quad);
+        return rectangle<T>(quad);
+    }
+
+    std::mt19937 &Engine() {
+        return rng_;
+    }
+
+private:
+    std::mt19937 rng_;
+};
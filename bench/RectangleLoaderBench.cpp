@@ -0,0 +1,87 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <random>
+#include <string>
+#include <thread>
+#include "RandomRectangles.h"
+#include "RectangleLoader.h"
+
+// Throughput of RectangleLoader against reading the same file through
+// rectangle(std::istream&). Writes a file of random rotated rectangles with mixed
+// whitespace to path, loads it every way, checks the results match and removes it.
+//
+//     RectangleLoaderBench [rectangles] [max_threads] [path]
+
+namespace {
+
+    using Clock = std::chrono::steady_clock;
+    using Rectangles = Containers::Vector<rectangle<int>>;
+
+    size_t WriteFile(const std::string &path, size_t count) {
+        RandomRectangles generator;
+        std::uniform_int_distribution<int> separator(0, 7);
+        const char *separators[] = {" ", " ", " ", "  ", "\t", "\r\n", "\n", " \r\n"};
+        std::string text;
+        for (size_t i = 0; i < count; ++i) {
+            vertex<int> corners[4];
+            generator.Corners(100000, 1000, corners);
+            for (const vertex<int> &corner : corners) {
+                for (int coordinate : {corner.x, corner.y}) {
+                    text += std::to_string(coordinate);
+                    text += separators[separator(generator.Engine())];
+                }
+            }
+        }
+        std::ofstream file(path, std::ios::binary);
+        file << text;
+        return text.size();
+    }
+
+    double Seconds(Clock::time_point start) {
+        return std::chrono::duration<double>(Clock::now() - start).count();
+    }
+
+}
+
+int main(int argc, char **argv) {
+    size_t count = argc > 1 ? std::stoul(argv[1]) : 2000000;
+    size_t max_threads = argc > 2 ? std::stoul(argv[2]) : std::max(1u, std::thread::hardware_concurrency());
+    std::string path = argc > 3 ? argv[3] : "rectangles_bench.txt";
+
+    double megabytes = double(WriteFile(path, count)) / 1e6;
+    std::printf("%zu rectangles, %.1f MB\n", count, megabytes);
+
+    Rectangles expected;
+    expected.Reserve(count);
+    Clock::time_point start = Clock::now();
+    {
+        std::ifstream file(path);
+        for (size_t i = 0; i < count; ++i) {
+            expected.PushBack(rectangle<int>(file));
+        }
+    }
+    std::printf("%-20s %8.1f MB/s\n", "istream", megabytes / Seconds(start));
+
+    auto load = [&](const char *name, Parallel::ThreadPool *pool) {
+        Rectangles rects;
+        Containers::RectangleLoader<int> loader(pool);
+        Clock::time_point load_start = Clock::now();
+        loader.Load(path, rects);
+        std::printf("%-20s %8.1f MB/s\n", name, megabytes / Seconds(load_start));
+        if (rects.Size() != count || !std::equal(rects.begin(), rects.end(), expected.begin())) {
+            std::fprintf(stderr, "%s read different rectangles than the istream path\n", name);
+            std::remove(path.c_str());
+            std::exit(1);
+        }
+    };
+    load("loader, serial", nullptr);
+    for (size_t threads = 1; threads <= max_threads; threads *= 2) {
+        Parallel::ThreadPool pool(threads);
+        load(("loader, " + std::to_string(threads) + " threads").c_str(), &pool);
+    }
+    std::remove(path.c_str());
+    return 0;
+}
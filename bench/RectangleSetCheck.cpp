@@ -0,0 +1,70 @@
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+#include "RandomRectangles.h"
+#include "RectangleSet.h"
+#include "rectangle.h"
+
+// Checks the RectangleSet kernels against rectangle::area, rectangle::center and
+// area() < square on random rotated rectangles, for every size up to a few packs
+// (so that each scalar tail length 0..width-1 is covered) and for one large set.
+// The pack width is fixed at compile time: RectangleSetCheck uses the default
+// target, RectangleSetCheckAvx is built with -mavx. Exits non-zero on a mismatch.
+//
+//     RectangleSetCheck [large_size]
+
+namespace {
+
+    RandomRectangles generator;
+
+    // Shifted by half a unit for double, so that the coordinates are not all integers.
+    template<class T>
+    rectangle<T> RandomRectangle() {
+        return generator.Next<T>(1 << 20, 1000, std::is_integral<T>::value ? T(0) : T(0.5));
+    }
+
+    // Returns the number of mismatching values.
+    template<class T>
+    size_t Check(size_t size) {
+        std::vector<rectangle<T>> rects;
+        RectangleSet<T> set;
+        for (size_t i = 0; i < size; ++i) {
+            rects.push_back(RandomRectangle<T>());
+            set.push_back(rects.back());
+        }
+        std::vector<double> areas(size), xs(size), ys(size);
+        set.areas(areas.data());
+        set.centers(xs.data(), ys.data());
+        size_t mismatches = 0;
+        for (size_t i = 0; i < size; ++i) {
+            vertex<double> center = rects[i].center();
+            mismatches += areas[i] != rects[i].area();
+            mismatches += xs[i] != center.x || ys[i] != center.y;
+        }
+        for (double square : {0.0, 1e5, 1e6 + 0.5, 4e6, 1e12}) {
+            size_t expected = 0;
+            for (const rectangle<T> &rect : rects) {
+                expected += rect.area() < square;
+            }
+            mismatches += set.count_area_less_than(square) != expected;
+        }
+        if (mismatches != 0) {
+            std::fprintf(stderr, "%zu mismatches for %zu %s rectangles\n", mismatches, size,
+                         std::is_integral<T>::value ? "int" : "double");
+        }
+        return mismatches;
+    }
+
+}
+
+int main(int argc, char **argv) {
+    size_t large_size = argc > 1 ? std::stoul(argv[1]) : 100001;
+    size_t mismatches = 0;
+    for (size_t size = 0; size <= 4 * SimdPack::width + 3; ++size) {
+        mismatches += Check<int>(size) + Check<double>(size);
+    }
+    mismatches += Check<int>(large_size) + Check<double>(large_size);
+    std::printf("pack width %zu: %zu mismatches\n", SimdPack::width, mismatches);
+    return mismatches == 0 ? 0 : 1;
+}
@@ -0,0 +1,163 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+#include "RandomRectangles.h"
+#include "SpatialGrid.h"
+#include "Vector.h"
+
+// Bulk load, query and update benchmark of SpatialGrid against linear scans over
+// the same vector. Rectangles are rotated and mostly small, with one in ten much
+// larger, scattered over a square world.
+//
+//     SpatialGridBench [rectangles]
+
+namespace {
+
+    using Containers::BoundingBox;
+    using Clock = std::chrono::steady_clock;
+
+    constexpr int kWorld = 5000;
+    constexpr size_t kGridQueries = 1000;
+    constexpr size_t kLinearQueries = 10;
+
+    RandomRectangles generator;
+
+    rectangle<int> RandomRectangle() {
+        int size = generator.Engine()() % 10 == 0 ? 80 : 6;
+        return generator.Next<int>(kWorld, size);
+    }
+
+    vertex<double> RandomPoint() {
+        return {double(generator.Random(kWorld)), double(generator.Random(kWorld))};
+    }
+
+    double Milliseconds(Clock::time_point start) {
+        return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    }
+
+    double Dot(vertex<double> a, vertex<double> b) {
+        return a.x * b.x + a.y * b.y;
+    }
+
+    vertex<double> Corner(const rectangle<int> &rect, size_t i) {
+        return {double(rect.vertices[i].x), double(rect.vertices[i].y)};
+    }
+
+    bool Contains(const rectangle<int> &rect, vertex<double> point) {
+        vertex<double> origin = Corner(rect, 0);
+        vertex<double> offset = {point.x - origin.x, point.y - origin.y};
+        for (size_t i : {1, 3}) {
+            vertex<double> side = {Corner(rect, i).x - origin.x, Corner(rect, i).y - origin.y};
+            double along = Dot(offset, side);
+            if (along < 0 || along > Dot(side, side)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Separating axis test on the axes of the region and of the rectangle.
+    bool Intersects(const rectangle<int> &rect, const BoundingBox &region) {
+        vertex<double> origin = Corner(rect, 0);
+        vertex<double> axes[4] = {{1, 0}, {0, 1},
+                                  {Corner(rect, 1).x - origin.x, Corner(rect, 1).y - origin.y},
+                                  {Corner(rect, 3).x - origin.x, Corner(rect, 3).y - origin.y}};
+        vertex<double> corners[4] = {region.min, {region.min.x, region.max.y}, region.max, {region.max.x, region.min.y}};
+        for (const vertex<double> &axis : axes) {
+            double low = Dot(Corner(rect, 0), axis), high = low;
+            for (size_t i = 1; i < 4; ++i) {
+                low = std::min(low, Dot(Corner(rect, i), axis));
+                high = std::max(high, Dot(Corner(rect, i), axis));
+            }
+            double region_low = Dot(corners[0], axis), region_high = region_low;
+            for (const vertex<double> &corner : corners) {
+                region_low = std::min(region_low, Dot(corner, axis));
+                region_high = std::max(region_high, Dot(corner, axis));
+            }
+            if (high < region_low || region_high < low) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    BoundingBox RandomRegion() {
+        vertex<double> corner = RandomPoint();
+        return {corner, {corner.x + 50, corner.y + 50}};
+    }
+
+}
+
+int main(int argc, char **argv) {
+    size_t count = argc > 1 ? std::stoul(argv[1]) : 1000000;
+    Containers::Vector<rectangle<int>> rects;
+    rects.Reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        rects.PushBack(RandomRectangle());
+    }
+    size_t hits = 0;
+
+    Clock::time_point start = Clock::now();
+    Containers::SpatialGrid<int> grid;
+    grid.Build(rects.begin(), rects.end());
+    std::printf("%zu rectangles, bulk load %.0f ms\n", count, Milliseconds(start));
+    std::printf("%16s %14s %14s\n", "ms per query", "grid", "linear scan");
+
+    start = Clock::now();
+    for (size_t i = 0; i < kGridQueries; ++i) {
+        hits += grid.Containing(RandomPoint()).size();
+    }
+    double grid_ms = Milliseconds(start) / kGridQueries;
+    start = Clock::now();
+    for (size_t i = 0; i < kLinearQueries; ++i) {
+        vertex<double> point = RandomPoint();
+        hits += std::count_if(rects.begin(), rects.end(), [&](const rectangle<int> &rect) { return Contains(rect, point); });
+    }
+    std::printf("%16s %14.4f %14.2f\n", "containing", grid_ms, Milliseconds(start) / kLinearQueries);
+
+    start = Clock::now();
+    for (size_t i = 0; i < kGridQueries; ++i) {
+        hits += grid.Intersecting(RandomRegion()).size();
+    }
+    grid_ms = Milliseconds(start) / kGridQueries;
+    start = Clock::now();
+    for (size_t i = 0; i < kLinearQueries; ++i) {
+        BoundingBox region = RandomRegion();
+        hits += std::count_if(rects.begin(), rects.end(), [&](const rectangle<int> &rect) { return Intersects(rect, region); });
+    }
+    std::printf("%16s %14.4f %14.2f\n", "intersecting", grid_ms, Milliseconds(start) / kLinearQueries);
+
+    start = Clock::now();
+    for (size_t i = 0; i < kGridQueries; ++i) {
+        hits += grid.Nearest(RandomPoint(), 10).size();
+    }
+    grid_ms = Milliseconds(start) / kGridQueries;
+    start = Clock::now();
+    std::vector<std::pair<double, size_t>> distances(count);
+    for (size_t i = 0; i < kLinearQueries; ++i) {
+        vertex<double> point = RandomPoint();
+        for (size_t id = 0; id < count; ++id) {
+            vertex<double> center = rects[id].center();
+            double dx = center.x - point.x, dy = center.y - point.y;
+            distances[id] = {dx * dx + dy * dy, id};
+        }
+        std::partial_sort(distances.begin(), distances.begin() + std::min<size_t>(10, count), distances.end());
+        hits += distances.empty() ? 0 : distances[0].second;
+    }
+    std::printf("%16s %14.4f %14.2f\n", "10 nearest", grid_ms, Milliseconds(start) / kLinearQueries);
+
+    size_t updates = std::min<size_t>(100000, count);
+    start = Clock::now();
+    for (size_t i = 0; i < updates && count != 0; ++i) {
+        size_t id = generator.Engine()() % count;
+        rects[id] = RandomRectangle();
+        grid.Update(id, rects[id]);
+    }
+    std::printf("update %.2f us each\n", Milliseconds(start) * 1000 / double(std::max<size_t>(updates, 1)));
+    std::printf("(%zu hits)\n", hits);
+    return 0;
+}
@@ -0,0 +1,203 @@
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include "Stack.h"
+
+// Stack with raw pointer links against the shared_ptr/weak_ptr list it replaced:
+// pushes, full iterations, and erase plus insert at the front. The old list is kept
+// here, trimmed to the operations measured; destroying it recurses once per node,
+// so keep the element count well below 100k.
+//
+//     StackBench [elements] [iterations]
+
+namespace {
+
+    namespace Shared {
+
+        template <typename T>
+        struct StackNode {
+            T data;
+            std::shared_ptr<StackNode> next;
+            std::weak_ptr<StackNode> prev;
+        };
+
+        template <typename T>
+        struct StackIterator {
+            StackIterator(std::shared_ptr<StackNode<T>> ptr) : ptr_(ptr) {}
+
+            T& operator * () {
+                std::shared_ptr<StackNode<T>> locked = ptr_.lock();
+                if (!locked) {
+                    throw std::runtime_error("Iterator does not exist");
+                }
+                return locked->data;
+            }
+
+            StackIterator& operator++() {
+                std::shared_ptr<StackNode<T>> locked = ptr_.lock();
+                if (!locked || locked->next == nullptr) {
+                    throw std::runtime_error("Out of bounds");
+                }
+                ptr_ = locked->next;
+                return *this;
+            }
+
+            bool operator == (const StackIterator& other) const {
+                return ptr_.lock() == other.ptr_.lock();
+            }
+
+            bool operator != (const StackIterator& other) const {
+                return !(*this == other);
+            }
+
+            std::weak_ptr<StackNode<T>> ptr_;
+        };
+
+        template <typename T>
+        class Stack {
+        public:
+            Stack() : tail(NewNode()), head(tail) {}
+
+            bool Empty() const {
+                return head == tail;
+            }
+
+            void Push(T elem) {
+                auto new_elem = NewNode();
+                new_elem->data = std::move(elem);
+                if (Empty()) {
+                    head = new_elem;
+                    tail->prev = head;
+                    head->next = tail;
+                    return;
+                }
+                std::shared_ptr<StackNode<T>> prev_ptr = tail->prev.lock();
+                prev_ptr->next = new_elem;
+                tail->prev = new_elem;
+                new_elem->next = tail;
+                new_elem->prev = prev_ptr;
+            }
+
+            StackIterator<T> begin() {
+                return StackIterator<T>(head);
+            }
+
+            StackIterator<T> end() {
+                return StackIterator<T>(tail);
+            }
+
+            void Insert(StackIterator<T> iter, T elem) {
+                auto new_elem = NewNode();
+                new_elem->data = std::move(elem);
+                if (iter == begin()) {
+                    new_elem->next = head;
+                    head->prev = new_elem;
+                    head = new_elem;
+                } else {
+                    std::shared_ptr<StackNode<T>> cur_ptr = iter.ptr_.lock();
+                    std::shared_ptr<StackNode<T>> prev_ptr = cur_ptr->prev.lock();
+                    prev_ptr->next = new_elem;
+                    cur_ptr->prev = new_elem;
+                    new_elem->next = cur_ptr;
+                    new_elem->prev = prev_ptr;
+                }
+            }
+
+            void Erase(StackIterator<T> iter) {
+                if (iter == end()) {
+                    throw std::runtime_error("Erasind end iterator");
+                }
+                std::shared_ptr<StackNode<T>> ptr = iter.ptr_.lock();
+                if (iter == begin()) {
+                    head = head->next;
+                    ptr->next = nullptr;
+                } else {
+                    std::shared_ptr<StackNode<T>> prev_ptr = ptr->prev.lock();
+                    std::shared_ptr<StackNode<T>> next_ptr = ptr->next;
+                    prev_ptr->next = next_ptr;
+                    next_ptr->prev = prev_ptr;
+                }
+            }
+
+        private:
+            // Node and control block are separate allocations, as they were with the
+            // deleter the old Stack passed to shared_ptr.
+            static std::shared_ptr<StackNode<T>> NewNode() {
+                return std::shared_ptr<StackNode<T>>(new StackNode<T>());
+            }
+
+            std::shared_ptr<StackNode<T>> tail;
+            std::shared_ptr<StackNode<T>> head;
+        };
+
+    }
+
+    using Clock = std::chrono::steady_clock;
+
+    double Milliseconds(Clock::time_point start) {
+        return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    }
+
+    struct Timings {
+        double push;
+        double iterate;
+        double churn;
+        long long checksum;
+    };
+
+    template <typename Stack>
+    Timings Run(size_t elements, size_t iterations) {
+        Timings timings;
+        Stack stack;
+        auto start = Clock::now();
+        for (size_t i = 0; i < elements; ++i) {
+            stack.Push(int(i));
+        }
+        timings.push = Milliseconds(start);
+
+        long long sum = 0;
+        start = Clock::now();
+        for (size_t round = 0; round < iterations; ++round) {
+            for (auto it = stack.begin(); it != stack.end(); ++it) {
+                sum += *it;
+            }
+        }
+        timings.iterate = Milliseconds(start);
+
+        start = Clock::now();
+        for (size_t i = 0; i < elements; ++i) {
+            int value = *stack.begin();
+            stack.Erase(stack.begin());
+            stack.Insert(stack.begin(), value + 1);
+        }
+        timings.churn = Milliseconds(start);
+
+        for (auto it = stack.begin(); it != stack.end(); ++it) {
+            sum += *it;
+        }
+        timings.checksum = sum;
+        return timings;
+    }
+
+}
+
+int main(int argc, char **argv) {
+    size_t elements = argc > 1 ? std::stoul(argv[1]) : 20000;
+    size_t iterations = argc > 2 ? std::stoul(argv[2]) : 200;
+    Timings shared = Run<Shared::Stack<int>>(elements, iterations);
+    Timings raw = Run<Containers::Stack<int>>(elements, iterations);
+    if (shared.checksum != raw.checksum) {
+        std::fprintf(stderr, "the two stacks hold different values\n");
+        return 1;
+    }
+    std::printf("%zu elements, ms\n", elements);
+    std::printf("%-24s %12s %12s\n", "", "shared_ptr", "raw links");
+    std::printf("%-24s %12.2f %12.2f\n", "push", shared.push, raw.push);
+    std::printf("%-24s %12.2f %12.2f\n", ("iterate x" + std::to_string(iterations)).c_str(), shared.iterate,
+                raw.iterate);
+    std::printf("%-24s %12.2f %12.2f\n", "erase + insert at front", shared.churn, raw.churn);
+    return 0;
+}
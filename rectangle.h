@@ -2,24 +2,155 @@
 #define D_RECTANGLE_H_ 1
 
 #include <algorithm>
+#include <cmath>
+#include <cstdint>
 #include <iostream>
+#include <stdexcept>
+#include <type_traits>
 
 #include "vertex.h"
 #include "vector_.h"
 
+// Whether a * b < c * d, computed exactly on the full 128-bit products.
+constexpr bool product_less(uint64_t a, uint64_t b, uint64_t c, uint64_t d) {
+	auto wide = [](uint64_t x, uint64_t y, uint64_t& hi, uint64_t& lo) {
+		uint64_t x_lo = x & 0xffffffffu, x_hi = x >> 32, y_lo = y & 0xffffffffu, y_hi = y >> 32;
+		uint64_t low = x_lo * y_lo, mid1 = x_hi * y_lo, mid2 = x_lo * y_hi;
+		uint64_t carry = ((low >> 32) + (mid1 & 0xffffffffu) + (mid2 & 0xffffffffu)) >> 32;
+		lo = x * y;
+		hi = x_hi * y_hi + (mid1 >> 32) + (mid2 >> 32) + carry;
+	};
+	uint64_t lhs_hi = 0, lhs_lo = 0, rhs_hi = 0, rhs_lo = 0;
+	wide(a, b, lhs_hi, lhs_lo);
+	wide(c, d, rhs_hi, rhs_lo);
+	return lhs_hi < rhs_hi || (lhs_hi == rhs_hi && lhs_lo < rhs_lo);
+}
+
+// Integer coordinates of rectangles must lie strictly within +-2^30: differences
+// then stay below 2^31, so squared side lengths, dot and cross products, and sums
+// of four coordinates fit into signed 64-bit integers.
+constexpr int64_t max_coordinate = int64_t(1) << 30;
+
+template<class T>
+constexpr bool in_range(vertex<T> v) {
+	if constexpr (std::is_integral<T>::value) {
+		return -max_coordinate < v.x && v.x < max_coordinate && -max_coordinate < v.y && v.y < max_coordinate;
+	} else {
+		return true;
+	}
+}
+
+// Squared distances are exact 64-bit integers for integer coordinates in range.
+template<class T>
+using squared_length_t = std::conditional_t<std::is_integral<T>::value, uint64_t, double>;
+
+// Squares the magnitudes in unsigned arithmetic, so that coordinates out of range
+// give a wrong result rather than undefined behaviour.
+template<class T>
+constexpr squared_length_t<T> squared_distance(vertex<T> a, vertex<T> b) {
+	if constexpr (std::is_integral<T>::value) {
+		auto magnitude = [](T from, T to) {
+			return to < from ? uint64_t(from) - uint64_t(to) : uint64_t(to) - uint64_t(from);
+		};
+		uint64_t dx = magnitude(a.x, b.x);
+		uint64_t dy = magnitude(a.y, b.y);
+		return dx * dx + dy * dy;
+	} else {
+		double dx = double(b.x) - double(a.x);
+		double dy = double(b.y) - double(a.y);
+		return dx * dx + dy * dy;
+	}
+}
+
+enum class rectangle_status {
+	valid,
+	equal_points,
+	not_perpendicular,
+	out_of_range
+};
+
+constexpr const char* rectangle_status_message(rectangle_status status) {
+	switch (status) {
+	case rectangle_status::equal_points:
+		return "No points are able to be equal";
+	case rectangle_status::not_perpendicular:
+		return "That's not a Rectangle, sides are not Perpendicular";
+	case rectangle_status::out_of_range:
+		return "Coordinates must lie strictly within +-2^30";
+	default:
+		return "Rectangle";
+	}
+}
+
+// Four distinct points form a rectangle when they split into two diagonals with a
+// common midpoint and equal lengths. The vertex opposite to the first one is found
+// in one pass with exact arithmetic, and the vertices are reordered to go around
+// the rectangle: the first point stays in place when possible, the same order the
+// perpendicularity checks of rectangle(std::istream&) used to pick.
+template<class T>
+constexpr rectangle_status validate_rectangle(vertex<T> (&v)[4]) {
+	using wide = std::conditional_t<std::is_integral<T>::value, int64_t, double>;
+	for (int i = 0; i < 4; ++i) {
+		if (!in_range(v[i])) return rectangle_status::out_of_range;
+	}
+	for (int i = 0; i < 4; ++i) {
+		for (int j = i + 1; j < 4; ++j) {
+			if (v[i] == v[j]) return rectangle_status::equal_points;
+		}
+	}
+	for (int k = 1; k < 4; ++k) {
+		int i = k == 1 ? 2 : 1;
+		int j = k == 3 ? 2 : 3;
+		if (wide(v[0].x) + wide(v[k].x) == wide(v[i].x) + wide(v[j].x) &&
+			wide(v[0].y) + wide(v[k].y) == wide(v[i].y) + wide(v[j].y) &&
+			squared_distance(v[0], v[k]) == squared_distance(v[i], v[j])) {
+			int from = k == 1 ? 0 : 2;
+			if (k != 2) {
+				vertex<T> tmp = v[from];
+				v[from] = v[3];
+				v[3] = tmp;
+			}
+			return rectangle_status::valid;
+		}
+	}
+	return rectangle_status::not_perpendicular;
+}
+
+// Validates and reorders count quads in place, writing one status per quad instead
+// of throwing. Returns how many of them are rectangles.
+template<class T>
+size_t validate_rectangles(vertex<T> (*quads)[4], size_t count, rectangle_status* statuses) {
+	size_t valid = 0;
+	for (size_t i = 0; i < count; ++i) {
+		statuses[i] = validate_rectangle(quads[i]);
+		valid += statuses[i] == rectangle_status::valid;
+	}
+	return valid;
+}
+
+// Area, squared side lengths and center are computed once by update(), which the
+// stream constructor calls; call it again after changing vertices directly.
 template<class T>
 struct rectangle {
 	vertex<T> vertices[4];
 	bool existance;
+	double cached_area;
+	vertex<double> cached_center;
+	squared_length_t<T> squared_sides[2];
 
 	rectangle(std::istream& is);
+	// Takes vertices already ordered by validate_rectangle.
+	explicit rectangle(const vertex<T> (&ordered)[4]);
 	rectangle() = default;
 
+	void update();
+
 	vertex<double> center() const;
 
 	bool operator==(const rectangle<T>& comp) const;
 
 	double area() const;
+	bool area_less_than(double square) const;
 	void print() const;
 };
 
@@ -31,44 +162,58 @@ rectangle<T>::rectangle(std::istream& is) {
 		is >> vertices[i];
 	}
 
-	if (isPerpendicular(Vector< vertex<T> >(vertices[0], vertices[1]), Vector< vertex<T> >(vertices[0], vertices[3])) && isPerpendicular(Vector< vertex<T> >(vertices[0], vertices[1]), Vector< vertex<T> >(vertices[1], vertices[2])) && 
-		isPerpendicular(Vector< vertex<T> >(vertices[1], vertices[2]), Vector< vertex<T> >(vertices[2], vertices[3])) && isPerpendicular(Vector< vertex<T> >(vertices[2], vertices[3]), Vector< vertex<T> >(vertices[0], vertices[3]))) {
-
-
-
-	} else if (isPerpendicular(Vector< vertex<T> >(vertices[0], vertices[3]), Vector< vertex<T> >(vertices[3], vertices[1])) && isPerpendicular(Vector< vertex<T> >(vertices[3], vertices[1]), Vector< vertex<T> >(vertices[1], vertices[2])) && 
-		isPerpendicular(Vector< vertex<T> >(vertices[1], vertices[2]), Vector< vertex<T> >(vertices[2], vertices[0])) && isPerpendicular(Vector< vertex<T> >(vertices[0], vertices[2]), Vector< vertex<T> >(vertices[0], vertices[3]))) {
-
-			vertex<T> tmp;
-			tmp = vertices[0];
-			vertices[0] = vertices[3];
-			vertices[3] = tmp;
-
-	} else if (isPerpendicular(Vector< vertex<T> >(vertices[0], vertices[1]), Vector< vertex<T> >(vertices[1], vertices[3])) && isPerpendicular(Vector< vertex<T> >(vertices[1], vertices[3]), Vector< vertex<T> >(vertices[3], vertices[2])) && 
-		isPerpendicular(Vector< vertex<T> >(vertices[3], vertices[2]), Vector< vertex<T> >(vertices[2], vertices[0])) && isPerpendicular(Vector< vertex<T> >(vertices[2], vertices[0]), Vector< vertex<T> >(vertices[0], vertices[1]))) {
-
-			vertex<T> tmp;
-			tmp = vertices[2];
-			vertices[2] = vertices[3];
-			vertices[3] = tmp;
-
-	} else if (vertices[0] == vertices[1] || vertices[0] == vertices[2] || vertices[0] == vertices[3] || vertices[1] == vertices[2] || vertices[1] == vertices[3] || vertices[2] == vertices[3]) {
-		throw std::logic_error("No points are able to be equal");
-	} else {
-		throw std::logic_error("That's not a Rectangle, sides are not Perpendicular");
+	rectangle_status status = validate_rectangle(vertices);
+	if (status != rectangle_status::valid) {
+		throw std::logic_error(rectangle_status_message(status));
 	}
 
-	if (!(Vector< vertex<T> >(vertices[0], vertices[1]).length() == Vector< vertex<T> >(vertices[2], vertices[3]).length() && Vector< vertex<T> >(vertices[1], vertices[2]).length() == Vector< vertex<T> >(vertices[0], vertices[3]).length())) {
-		throw std::logic_error("That's not a Rectangle, sides are not equal");
-	}
+	existance = true;
+	update();
+}
 
+template<class T>
+rectangle<T>::rectangle(const vertex<T> (&ordered)[4]) {
+	std::copy(ordered, ordered + 4, vertices);
 	existance = true;
+	update();
+}
+
+template<class T>
+void rectangle<T>::update() {
+	cached_area = Vector< vertex<T> >(vertices[0], vertices[1]).length() * Vector< vertex<T> >(vertices[1], vertices[2]).length();
+	// Integer sums are taken in 64 bits and still divided as integers.
+	using wide = std::conditional_t<std::is_integral<T>::value, int64_t, T>;
+	cached_center.x = double((wide(vertices[0].x) + wide(vertices[1].x) + wide(vertices[2].x) + wide(vertices[3].x)) / 4);
+	cached_center.y = double((wide(vertices[0].y) + wide(vertices[1].y) + wide(vertices[2].y) + wide(vertices[3].y)) / 4);
+	squared_sides[0] = squared_distance(vertices[0], vertices[1]);
+	squared_sides[1] = squared_distance(vertices[1], vertices[2]);
 }
 
 template<class T>
 double rectangle<T>::area() const {
 	if (existance == false) std::logic_error("Object doesn't exist");
-	return Vector< vertex<T> >(vertices[0], vertices[1]).length() * Vector< vertex<T> >(vertices[1], vertices[2]).length();
+	return cached_area;
+}
+
+// The cached area is within a few ulps of the exact one, so for integer T only a
+// threshold closer than that is compared exactly: the squared area is an integer,
+// checked against the squared threshold, or against the two integers around a
+// fractional threshold. Exact for all coordinates validate_rectangle accepts.
+template<class T>
+bool rectangle<T>::area_less_than(double square) const {
+	if constexpr (std::is_integral<T>::value) {
+		const double margin = 1e-12;
+		bool below = cached_area < square - margin * square;
+		bool above = cached_area > square + margin * square;
+		if (below | above) return below;
+		if (!(square > 0)) return false;
+		double whole = std::floor(square);
+		uint64_t limit = uint64_t(whole);
+		if (whole == square) return product_less(squared_sides[0], squared_sides[1], limit, limit);
+		if (!product_less(limit, limit, squared_sides[0], squared_sides[1])) return true;
+		if (!product_less(squared_sides[0], squared_sides[1], limit + 1, limit + 1)) return false;
+	}
+	return cached_area < square;
 }
 
 template<class T>
@@ -80,10 +225,7 @@ void rectangle<T>::print() const {
 template<class T>
 vertex<double> rectangle<T>::center() const {
 	if (existance == false) std::logic_error("Object doesn't exist");
-	vertex<double> p;
-	p.x = (vertices[0].x + vertices[1].x + vertices[2].x + vertices[3].x) / 4;
-	p.y = (vertices[0].y + vertices[1].y + vertices[2].y + vertices[3].y) / 4;
-	return p;
+	return cached_center;
 }
 
 template<class T>
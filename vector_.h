@@ -3,49 +3,77 @@
 
 #include "vertex.h"
 #include <cmath>
+#include <cstdint>
 #include <numeric>
 #include <limits>
+#include <type_traits>
 
+// Difference of two vertices. Integer coordinates are kept in 64-bit integers, so
+// products and predicates are exact for coordinates strictly within +-2^30;
+// floating point ones are kept in double. Everything except length() is constexpr.
+// length() is defined for the difference of any two 32-bit integer vertices.
 template<class T>
 struct Vector {
-	explicit Vector(T a, T b);
+	using coordinate = decltype(T::x);
+	using value_type = std::conditional_t<std::is_integral<coordinate>::value, int64_t, double>;
+
+	constexpr explicit Vector(T a, T b);
 	double length() const;
-	double x;
-	double y;
-	double operator* (Vector b) ;
-	bool operator== (Vector b);
+	value_type x;
+	value_type y;
+	constexpr value_type operator* (Vector b) const;
+	constexpr bool operator== (Vector b) const;
 };
 
 template<class T>
-Vector<T>::Vector(T a, T b) {
-	x = b.x - a.x;
-	y = b.y - a.y;
+constexpr Vector<T>::Vector(T a, T b) : x(value_type(b.x) - value_type(a.x)), y(value_type(b.y) - value_type(a.y)) {
 }
 
+// Squares the magnitudes in unsigned 64-bit arithmetic and adds them exactly when
+// the sum fits, otherwise in double.
 template<class T>
 double Vector<T>::length() const{
-	return sqrt(x * x + y * y);
+	if constexpr (std::is_integral<value_type>::value) {
+		uint64_t ux = x < 0 ? 0 - uint64_t(x) : uint64_t(x);
+		uint64_t uy = y < 0 ? 0 - uint64_t(y) : uint64_t(y);
+		const uint64_t limit = uint64_t(1) << 32;
+		if (ux < limit && uy < limit && ux * ux <= UINT64_MAX - uy * uy) {
+			return sqrt(double(ux * ux + uy * uy));
+		}
+		return sqrt(double(ux) * double(ux) + double(uy) * double(uy));
+	} else {
+		return sqrt(x * x + y * y);
+	}
 }
 
 template<class T>
-double Vector<T>::operator* (Vector<T> b) {
+constexpr typename Vector<T>::value_type Vector<T>::operator* (Vector<T> b) const {
 	return x * b.x + y * b.y;
 }
 
 template<class T>
-bool Vector<T>::operator== (Vector<T> b) {
-	return std::abs(x - b.x) < std::numeric_limits<double>::epsilon() * 100 
-	&& std::abs(y - b.y) < std::numeric_limits<double>::epsilon() * 100;
+constexpr bool Vector<T>::operator== (Vector<T> b) const {
+	if constexpr (std::is_integral<value_type>::value) {
+		return x == b.x && y == b.y;
+	} else {
+		return (x > b.x ? x - b.x : b.x - x) < std::numeric_limits<double>::epsilon() * 100 
+		&& (y > b.y ? y - b.y : b.y - y) < std::numeric_limits<double>::epsilon() * 100;
+	}
+}
+
+template<class T>
+constexpr typename Vector<T>::value_type cross(const Vector<T> a, const Vector<T> b) {
+	return a.x * b.y - a.y * b.x;
 }
 
 template<class T>
-bool isParallel(const Vector<T> a, const Vector<T> b) {
-	return (a.x * b.y - a.y * b.y) == 0;
+constexpr bool isParallel(const Vector<T> a, const Vector<T> b) {
+	return cross(a, b) == 0;
 }
 
 template<class T>
-bool isPerpendicular(const Vector<T> a, const Vector<T> b) {
-	return (a.x * b.x + a.y * b.y) == 0;
+constexpr bool isPerpendicular(const Vector<T> a, const Vector<T> b) {
+	return a * b == 0;
 }
 
 
@@ -23,26 +23,26 @@ std::ostream& operator<< (std::ostream& os, const vertex<T>& p) {
 }
 
 template<class T>
-vertex<T> operator+(vertex<T> lhs,vertex<T> rhs){
-    vertex<T> res;
+constexpr vertex<T> operator+(vertex<T> lhs,vertex<T> rhs){
+    vertex<T> res{};
     res.x = lhs.x + rhs.x;
     res.y = lhs.y + rhs.y;
     return res;
 }
 
 template<class T>
-bool operator == (vertex<T> a, vertex<T> b) {
+constexpr bool operator == (vertex<T> a, vertex<T> b) {
 	return (a.x == b.x && a.y == b.y);
 }
 
 template<class T>
-bool operator != (vertex<T> a, vertex<T> b) {
+constexpr bool operator != (vertex<T> a, vertex<T> b) {
 	return (a.x != b.x || a.y != b.y);
 }
 
 
 template<class T>
-vertex<T>& operator/= (vertex<T>& vertex, int number) {
+constexpr vertex<T>& operator/= (vertex<T>& vertex, int number) {
     vertex.x = vertex.x / number;
     vertex.y = vertex.y / number;
     return vertex;